@@ -11,18 +11,30 @@
 #pragma once
 
 #include "torch_ucc_comm.hpp"
-
+#include "torch_ucc_metrics.hpp"
+#include "torch_ucc_pool.hpp"
+#include "torch_ucc_queue.hpp"
+#include "torch_ucc_tune.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <exception>
+#include <functional>
+#include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <c10d/ProcessGroup.hpp>
 #include <c10d/Store.hpp>
 #include <c10d/Types.hpp>
 #include <c10d/Utils.hpp>
+#include <torch/version.h>
 #ifdef USE_CUDA
 #include <ATen/cuda/CUDAEvent.h>
 #include <c10/cuda/CUDAStream.h>
@@ -32,6 +44,17 @@ namespace c10d {
 
 #define TORCH_UCC_DEVICE_NOT_SET -2
 
+// segment free events of the caching allocator need torch 2.1, passing
+// memory handles to tag send/recv needs UCP 1.14
+#if defined(USE_CUDA) &&        \
+    (TORCH_VERSION_MAJOR > 2 || \
+     (TORCH_VERSION_MAJOR == 2 && TORCH_VERSION_MINOR >= 1))
+#define TORCH_UCC_SEGMENT_EVENTS
+#if UCP_API_VERSION >= UCP_VERSION(1, 14)
+#define TORCH_UCX_MEMH_CACHE
+#endif
+#endif
+
 #define TORCH_UCX_MAKE_P2P_TAG(_tag, _rank, _comm)       \
   ((((uint64_t)(_tag)) << TORCH_UCX_TAG_BITS_OFFSET) |   \
    (((uint64_t)(_rank)) << TORCH_UCX_RANK_BITS_OFFSET) | \
@@ -94,6 +117,38 @@ constexpr const char* UCC_BACKEND_NAME = "ucc";
 
 enum torch_ucx_tag_type_t { TORCH_UCX_P2P_TAG, TORCH_UCX_OOB_TAG };
 
+enum torch_ucc_progress_state_t {
+  TORCH_UCC_PROGRESS_RUNNING,
+  TORCH_UCC_PROGRESS_SLEEP_CV,
+  TORCH_UCC_PROGRESS_SLEEP_EFD,
+};
+
+// UCX endpoints of a process group. Worker addresses of all ranks are
+// exchanged when the group is initialized, endpoints are created on first
+// send to a peer.
+struct torch_ucx_eps_t {
+  std::vector<ucp_ep_h> eps;
+  // worker addresses of all ranks, each padded to addr_len bytes
+  std::vector<uint8_t> addrs;
+  size_t addr_len = 0;
+  std::mutex mutex;
+};
+
+#ifdef TORCH_UCX_MEMH_CACHE
+// UCX registration of a CUDA caching allocator segment, unmapped once the
+// cache and all operations using it drop their references.
+struct torch_ucx_memh_t {
+  torch_ucx_memh_t(ucp_context_h context, ucp_mem_h memh, size_t size)
+      : context(context), memh(memh), size(size) {}
+  ~torch_ucx_memh_t() {
+    ucp_mem_unmap(context, memh);
+  }
+  ucp_context_h context;
+  ucp_mem_h memh;
+  size_t size;
+};
+#endif
+
 struct event_pool_t {
 #ifdef USE_CUDA
   std::queue<std::unique_ptr<at::cuda::CUDAEvent>> event_pool;
@@ -106,47 +161,207 @@ class CommPG;
 class ProcessGroupUCC : public ProcessGroup {
  private:
   void set_timeout(ucc_coll_args_t &args);
+  // timeout of works waited without explicit timeout
+  std::chrono::milliseconds default_wait_timeout() const;
 
  public:
-  class WorkData {
+  class WorkData : public SlabAllocated {
    public:
     std::vector<at::Tensor> src;
     std::vector<at::Tensor> dst;
     std::vector<at::Tensor> flat;
+    // set for collectives captured in a CUDA graph, replays keep using the
+    // buffers so they are not released on completion
+    bool keep_buffers = false;
+    // result is produced by complete on the progress thread, waits of CUDA
+    // collectives block the host instead of the current stream
+    bool host_completion = false;
     WorkData() {}
     virtual ~WorkData() = default;
+    // Called on the progress thread once the collective is done, before the
+    // work is marked completed.
+    virtual void complete(bool /* success */) {}
   };
   class AlltoallWorkData : public WorkData {
    public:
     AlltoallWorkData(int size)
-        : send_lengths(size),
-          send_offsets(size),
-          recv_lengths(size),
-          recv_offsets(size) {}
+        : send_lengths(CountsPool::acquire(size)),
+          send_offsets(CountsPool::acquire(size)),
+          recv_lengths(CountsPool::acquire(size)),
+          recv_offsets(CountsPool::acquire(size)) {}
+    ~AlltoallWorkData() override {
+      CountsPool::release(send_lengths);
+      CountsPool::release(send_offsets);
+      CountsPool::release(recv_lengths);
+      CountsPool::release(recv_offsets);
+    }
     std::vector<uint64_t> send_lengths;
     std::vector<uint64_t> send_offsets;
     std::vector<uint64_t> recv_lengths;
     std::vector<uint64_t> recv_offsets;
   };
 
+  // Counts and displacements of an uneven alltoall_base, cached by split
+  // sizes and shared by all calls with the same splits.
+  struct AlltoallSplits {
+    std::vector<int64_t> input_splits;
+    std::vector<int64_t> output_splits;
+    int64_t input_rows;
+    int64_t output_rows;
+    int64_t input_row_numel;
+    int64_t output_row_numel;
+    std::vector<uint64_t> send_lengths;
+    std::vector<uint64_t> send_offsets;
+    std::vector<uint64_t> recv_lengths;
+    std::vector<uint64_t> recv_offsets;
+  };
+
+  class CachedAlltoallWorkData : public WorkData {
+   public:
+    std::shared_ptr<const AlltoallSplits> splits;
+  };
+
   class AllgathervWorkData : public WorkData {
    public:
     AllgathervWorkData(int size)
-      : recv_lengths(size),
-        recv_offsets(size) {}
+      : recv_lengths(CountsPool::acquire(size)),
+        recv_offsets(CountsPool::acquire(size)) {}
+    ~AllgathervWorkData() override {
+      CountsPool::release(recv_lengths);
+      CountsPool::release(recv_offsets);
+    }
     std::vector<uint64_t> recv_lengths;
     std::vector<uint64_t> recv_offsets;
   };
 
+  // Packed indices and values of all ranks of a sparse allreduce, merge
+  // sums them into the result once they arrived.
+  class SparseAllreduceWorkData : public AllgathervWorkData {
+   public:
+    SparseAllreduceWorkData(int size) : AllgathervWorkData(size) {}
+    void complete(bool success) override {
+      if (success && merge) {
+        merge();
+      }
+      merge = nullptr;
+    }
+    std::function<void()> merge;
+  };
+
   class ScattervWorkData : public WorkData {
    public:
     ScattervWorkData(int size)
-      : send_lengths(size),
-        send_offsets(size) {}
+      : send_lengths(CountsPool::acquire(size)),
+        send_offsets(CountsPool::acquire(size)) {}
+    ~ScattervWorkData() override {
+      CountsPool::release(send_lengths);
+      CountsPool::release(send_offsets);
+    }
     std::vector<uint64_t> send_lengths;
     std::vector<uint64_t> send_offsets;
   };
 
+  // Work data of one shard of a CPU collective split across helper
+  // communicators, the original work data is completed by the last shard.
+  class ShardWorkData : public WorkData {
+   public:
+    struct Shared {
+      std::unique_ptr<WorkData> data;
+      c10::intrusive_ptr<c10::ivalue::Future> future;
+      std::atomic<size_t> pending;
+      std::atomic<bool> success{true};
+    };
+    explicit ShardWorkData(std::shared_ptr<Shared> shared)
+        : shared(std::move(shared)) {}
+    void complete(bool success) override;
+    std::shared_ptr<Shared> shared;
+  };
+
+  // Size classed free lists of staging memory used with
+  // TORCH_UCC_MEMORY_SAVING. Buffers are powers of two bytes, released
+  // buffers are kept while the pool holds at most TORCH_UCC_BUFFER_POOL_SIZE
+  // bytes and freed otherwise. CUDA buffers are keyed by the internal stream
+  // so reuse is ordered by it.
+  class BufferPool {
+   public:
+    explicit BufferPool(int64_t capacity) : capacity_(capacity) {}
+    // Byte buffer of at least nbytes, alloc creates one of the given size
+    // if the free list of key and size class is empty.
+    at::Tensor acquire(
+        const std::string& key,
+        int64_t nbytes,
+        const std::function<at::Tensor(int64_t)>& alloc);
+    void release(const std::string& key, at::Tensor buffer);
+    int64_t cachedBytes();
+
+   private:
+    std::mutex mutex_;
+    const int64_t capacity_;
+    int64_t cached_bytes_ = 0;
+    std::unordered_map<std::string, std::vector<at::Tensor>> free_;
+  };
+
+  // Flat buffer used to fuse several tensors into a single collective.
+  class StagingBuffer {
+   public:
+    StagingBuffer() : in_use(false) {}
+    ~StagingBuffer() {
+      if (pool) {
+        pool->release(pool_key, std::move(raw));
+      }
+    }
+    at::Tensor buffer;
+    // CPU buffers are reused only after the previous collective completed,
+    // CUDA buffers are cached per internal stream and ordered by it.
+    std::atomic<bool> in_use;
+    // pooled buffers go back to pool when the last user drops them
+    std::shared_ptr<BufferPool> pool;
+    std::string pool_key;
+    at::Tensor raw;
+  };
+
+  // Work data of collectives going through a staging buffer, the buffer is
+  // released once the collective is done.
+  class StagingWorkData : public WorkData {
+   public:
+    ~StagingWorkData() override {
+      release();
+    }
+    void complete(bool success) override {
+      if (success && unpack) {
+        unpack();
+      }
+      if (!keep_buffers) {
+        release();
+      }
+    }
+    void release() {
+      unpack = nullptr;
+      if (staging) {
+        staging->in_use = false;
+        staging = nullptr;
+      }
+    }
+    std::shared_ptr<StagingBuffer> staging;
+    // copies results out of the flat buffer, CPU only
+    std::function<void()> unpack;
+  };
+
+  // Request initialized with UCC_COLL_ARGS_FLAG_PERSISTENT, reposted by
+  // identical collectives instead of being initialized every time.
+  class PersistentCollective {
+   public:
+    PersistentCollective() : inflight(false) {}
+    ~PersistentCollective();
+    ucc_coll_req_h request{nullptr};
+    std::atomic<bool> inflight;
+    // copies of counts/displacements arrays referenced by the request
+    std::vector<std::vector<uint64_t>> counts;
+    // address ranges of the buffers, the request is dropped from the cache
+    // once the allocator releases any of them
+    std::vector<std::pair<uintptr_t, size_t>> buffers;
+  };
+
   class ProgressEntry {
     friend class ProcessGroupUCC;
     friend class CommPG;
@@ -156,16 +371,51 @@ class ProcessGroupUCC : public ProcessGroup {
         CommBase* comm,
         ucc_coll_req_h request)
         : status_(UCC_INPROGRESS), comm_(comm), request_(request) {}
-    void finalize(std::exception_ptr eptr = nullptr);
+    // Completes the entry. Without complete_future the future is left for
+    // completeFuture, UCX callbacks can't run user future callbacks from
+    // inside ucp_worker_progress.
+    void finalize(
+        std::exception_ptr eptr = nullptr,
+        bool complete_future = true);
+    // Completes future deferred by finalize, called once the entry is
+    // completed. Returns once the future is completed, also if another
+    // thread completes it.
+    void completeFuture();
+    // Blocks until finalize is done or deadline passes, returns false on
+    // timeout. Waits without deadline if it is null.
+    bool wait(const std::chrono::steady_clock::time_point* deadline);
+    bool completed() const {
+      return completed_;
+    }
     ucc_status_t status_;
     CommBase* comm_;
     ucc_coll_req_h request_;
     std::unique_ptr<WorkData> data;
     c10::intrusive_ptr<c10::ivalue::Future> future_;
     std::exception_ptr eptr_;
+    std::shared_ptr<PersistentCollective> persistent_;
+    // sender of completed p2p receive
+    int source_rank_{-1};
+    // set with TORCH_UCC_ENABLE_METRICS, finalize records the operation
+    std::shared_ptr<ProcessGroupUCCMetrics> metrics_;
+    ProcessGroupUCCMetrics::Sample sample_;
+    // time progress thread picked the entry up, 0 before that
+    std::atomic<int64_t> progress_ns_{0};
+
+   private:
+    // p2p entries can be finalized by UCX callback and by progress thread on
+    // progress failure, only the first call takes effect
+    std::atomic<bool> finalized_{false};
+    std::atomic<bool> completed_{false};
+    // future completion deferred by finalize and its result
+    std::atomic<bool> future_deferred_{false};
+    std::vector<at::Tensor> future_result_;
+    std::atomic<int> waiters_{0};
+    std::mutex completion_mutex_;
+    std::condition_variable completion_cv_;
   };
 
-  class WorkUCC : public ProcessGroup::Work {
+  class WorkUCC : public ProcessGroup::Work, public SlabAllocated {
     friend class ProcessGroupUCC;
     friend class CommPG;
 
@@ -185,15 +435,41 @@ class ProcessGroupUCC : public ProcessGroup {
     bool isCompleted() override;
     bool isSuccess() const override;
     bool wait(std::chrono::milliseconds timeout = kUnsetTimeout) override;
+    int sourceRank() const override;
     c10::intrusive_ptr<c10::ivalue::Future> getFuture() override;
     std::vector<at::Tensor> result() override;
 #ifdef USE_CUDA
+    // Number of chunks the collective was split into, 0 if not chunked.
+    size_t numChunks() const {
+      return chunks_.size();
+    }
+    // Makes current stream wait for chunk i only, no host synchronization.
+    void blockChunk(size_t i);
     std::unique_ptr<at::cuda::CUDAEvent> fence = nullptr;
     event_pool_t* ep = nullptr;
+    // fence of collectives captured in a CUDA graph and id of the capture,
+    // only streams capturing the same graph can wait on it
+    std::unique_ptr<at::cuda::CUDAEvent> capture_fence = nullptr;
+    unsigned long long capture_id = 0;
+    // fence orders the posting stream only, result is ready once the work
+    // completed
+    bool host_completion = false;
 #endif
+    // process group timeout applied by waits without explicit timeout, 0
+    // waits forever
+    std::chrono::milliseconds default_timeout_{0};
    protected:
+    // Waits for completion with TORCH_UCC_WAIT_MODE strategy, returns false
+    // if deadline passed first.
+    bool waitCompleted(const std::chrono::steady_clock::time_point* deadline);
     std::shared_ptr<ProgressEntry> entry_;
+    // works of collective chunks, set instead of entry_ when the collective
+    // is split by TORCH_UCC_CHUNK_SIZE, CPU helpers or hierarchical allreduce
+    std::vector<c10::intrusive_ptr<WorkUCC>> chunks_;
     c10::intrusive_ptr<ProcessGroupUCCLogger> logger_;
+    // copied to the progress entry when the collective is posted
+    std::shared_ptr<ProcessGroupUCCMetrics> metrics_;
+    ProcessGroupUCCMetrics::Sample sample_;
 
    private:
     // The future returned by getFuture.
@@ -202,6 +478,19 @@ class ProcessGroupUCC : public ProcessGroup {
     std::shared_ptr<std::vector<at::Tensor>> outputs_;
   };
 
+  // Covers all operations issued between groupStart and groupEnd.
+  class GroupWorkUCC : public ProcessGroup::Work {
+   public:
+    explicit GroupWorkUCC(std::vector<c10::intrusive_ptr<WorkUCC>> works)
+        : ProcessGroup::Work(-1, OpType::UNKNOWN), works_(std::move(works)) {}
+    bool isCompleted() override;
+    bool isSuccess() const override;
+    bool wait(std::chrono::milliseconds timeout = kUnsetTimeout) override;
+
+   private:
+    std::vector<c10::intrusive_ptr<WorkUCC>> works_;
+  };
+
   explicit ProcessGroupUCC(
       const c10::intrusive_ptr<Store>& store,
       int rank = -1,
@@ -210,6 +499,14 @@ class ProcessGroupUCC : public ProcessGroup {
 
   void initComm(c10::Device dev);
 
+  // Agrees on communicator id and connects endpoints in the background,
+  // team is created by initComm for the device of the first collective.
+  void initCommAsync();
+
+  // Connects endpoints and creates team for the group, shared with other
+  // groups over the same processes with TORCH_UCC_TEAM_CACHE.
+  void createTeam(c10::Device dev);
+
   ~ProcessGroupUCC() override;
 
   const std::string getBackendName() const override {
@@ -291,6 +588,18 @@ class ProcessGroupUCC : public ProcessGroup {
       std::vector<int64_t>& inputSplitSizes,
       const AllToAllOptions& opts = AllToAllOptions()) override;
 
+  // Convenience wrapper of alltoall_base for callers that only know their
+  // send splits. Splits are exchanged by a blocking host side alltoall
+  // first, then outputTensor is allocated to fit the received rows,
+  // outputSplitSizes is filled and the data exchange is posted as a second
+  // collective. Nothing is fused or pipelined, returns work of the data
+  // exchange.
+  c10::intrusive_ptr<ProcessGroup::Work> alltoallWithSplits(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes);
+
   c10::intrusive_ptr<ProcessGroup::Work> alltoall(
       std::vector<at::Tensor>& outputTensors,
       std::vector<at::Tensor>& inputTensors,
@@ -310,6 +619,64 @@ class ProcessGroupUCC : public ProcessGroup {
       std::vector<at::Tensor>& tensors,
       int tag) override;
 
+  // Starts a group of operations issued by the calling thread. Operations
+  // are posted as usual but handed to progress threads only at groupEnd, in
+  // a single batch. Groups can be nested, only the outermost groupEnd
+  // submits.
+  static void groupStart();
+
+  // Submits operations of the current group, returned work completes once
+  // all of them completed.
+  static c10::intrusive_ptr<ProcessGroup::Work> groupEnd();
+
+  // Names the buffer of the next allreduce or reduce_scatter issued by the
+  // calling thread, e.g. the index of a DDP gradient bucket. Compressed
+  // reductions keep error feedback per named bucket, reductions without a
+  // bucket get none.
+  static void setCompressionBucket(int64_t bucket);
+  // Returns and clears the bucket set by setCompressionBucket, -1 if none.
+  static int64_t takeCompressionBucket();
+
+  // Drops cached UCX registrations of CUDA allocator segments. Segments
+  // released by the allocator are dropped automatically.
+  static void clearMemhCache();
+
+  // Enables caching of initialized requests keyed on collective arguments,
+  // repeated identical collectives repost the cached request.
+  void setPersistentCollectives(bool enable);
+
+  // Drops all cached persistent requests.
+  void clearPersistentCollectives();
+
+#ifdef TORCH_UCC_SEGMENT_EVENTS
+  // Records range released by the allocator for all process groups, their
+  // cached requests on buffers overlapping it are dropped on next lookup.
+  static void persistent_segment_freed(uintptr_t base, size_t size);
+#endif
+
+  // Latency and bandwidth aggregates of completed operations, null unless
+  // TORCH_UCC_ENABLE_METRICS is set. Chunked and sharded collectives are
+  // recorded per chunk.
+  std::shared_ptr<ProcessGroupUCCMetrics> getMetrics() const {
+    return metrics;
+  }
+
+  // Benchmarks implementations of tuned operations on dev for message sizes
+  // up to TORCH_UCC_TUNE_MAX_SIZE and switches to the fastest per size,
+  // rank 0 stores the result in TORCH_UCC_TUNE_FILE if set. Collective over
+  // the group, replaces a loaded or earlier tuned table of dev.
+  void tune(c10::Device dev);
+
+  const ProcessGroupUCCTuneTable& getTuneTable() const {
+    return tune_table;
+  }
+
+  // Bytes of free staging buffers kept by TORCH_UCC_MEMORY_SAVING pool, 0
+  // without it.
+  int64_t getBufferPoolBytes() {
+    return buffer_pool ? buffer_pool->cachedBytes() : 0;
+  }
+
   static c10::intrusive_ptr<ProcessGroup> createProcessGroupUCC(
       const c10::intrusive_ptr<::c10d::Store>& store,
       int rank,
@@ -321,14 +688,203 @@ class ProcessGroupUCC : public ProcessGroup {
   std::shared_ptr<torch_ucc_oob_coll_info_t> oob;
   std::shared_ptr<CommPG> comm = {nullptr};
   uint32_t comm_id;
-  std::vector<ucp_ep_h> eps;
+  std::shared_ptr<torch_ucx_eps_t> eps;
   ucc_team_h team {nullptr};
+  // background initialization started by initCommAsync
+  std::thread init_thread;
+  std::exception_ptr init_eptr;
+  // internal stream and its execution engine, created for the device of the
+  // first CUDA collective of the group
   ucc_ee_h cuda_ee {nullptr};
 #ifdef USE_CUDA
   std::unique_ptr<at::cuda::CUDAStream> stream = nullptr;
   event_pool_t ep;
 #endif
   c10::intrusive_ptr<ProcessGroupUCCLogger> logger;
+  bool persistent_enabled;
+  std::shared_ptr<ProcessGroupUCCMetrics> metrics;
+  std::mutex persistent_mutex;
+  // most recently used first, evicted beyond TORCH_UCC_PERSISTENT_CACHE_SIZE
+  std::list<std::pair<std::string, std::shared_ptr<PersistentCollective>>>
+      persistent_lru;
+  std::unordered_map<
+      std::string,
+      std::list<std::pair<std::string, std::shared_ptr<PersistentCollective>>>::
+          iterator>
+      persistent_colls;
+  // requests of captured collectives, replays of the graph post them
+  std::vector<std::shared_ptr<PersistentCollective>> captured_persistent;
+#ifdef TORCH_UCC_SEGMENT_EVENTS
+  // registered for segment free events with the first cached CUDA request
+  std::once_flag persistent_attached;
+  // Address ranges released by the allocator since the last lookup, filled
+  // under the allocator lock like CommPG::memh_freed.
+  std::mutex persistent_freed_mutex;
+  std::vector<std::pair<uintptr_t, size_t>> persistent_freed;
+  // drops cached requests on released buffers, persistent_mutex held
+  void persistent_cache_erase_freed();
+#endif
+
+  // Persistent request for coll, null only if coll can't be cached or the
+  // TL doesn't support persistent requests, so all ranks take the same
+  // path. Reuses the cached request when it is idle, otherwise initializes
+  // a new one.
+  std::shared_ptr<PersistentCollective> get_persistent_collective(
+      const ucc_coll_args_t& coll,
+      bool captured = false);
+
+  // most recently used first, TORCH_UCC_ALLTOALL_SPLITS_CACHE entries
+  std::mutex splits_mutex;
+  std::list<std::shared_ptr<const AlltoallSplits>> splits_cache;
+  // Counts and displacements of alltoall_base with the given splits, from
+  // the cache when the same splits were seen recently.
+  std::shared_ptr<const AlltoallSplits> get_alltoall_splits(
+      const std::vector<int64_t>& outputSplitSizes,
+      const std::vector<int64_t>& inputSplitSizes,
+      const at::Tensor& outputTensor,
+      const at::Tensor& inputTensor);
+
+  ProcessGroupUCCTuneTable tune_table;
+  // Node index of every rank grouped by hostname or TORCH_UCC_HIER_LOCAL_SIZE,
+  // nodes numbered in order of first appearance. Collective over the group.
+  std::vector<int> node_layout();
+  // Tuning table key of the group on dev: world size, ranks per node and
+  // device type. Collective over the group.
+  std::string tune_key(c10::Device dev);
+  // Loads table of dev on its first collective, tunes it if TORCH_UCC_TUNE
+  // is set and the table has no entry for the group.
+  void autotune(c10::Device dev);
+  // Benchmarks all candidates and returns the fastest per size bucket,
+  // timings are agreed on so all ranks get the same rows.
+  ProcessGroupUCCTuneTable::Rows benchmark_candidates(c10::Device dev);
+  // Sum of COO tensors: entry counts are allgathered first, then indices
+  // and values of every rank travel in one allgatherv and are coalesced on
+  // the tensor's device. Blocks until counts are known.
+  c10::intrusive_ptr<ProcessGroup::Work> allreduce_sparse(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts);
+#ifdef USE_CUDA
+  // Posts coll as `chunks` back to back collectives on the internal stream,
+  // each chunk gets its own work and event.
+  void enqueue_chunked_collective(
+      std::unique_ptr<WorkData> data,
+      c10::intrusive_ptr<WorkUCC> work,
+      ucc_coll_args_t& coll,
+      size_t element_size,
+      size_t chunks);
+#endif
+  // Posts coll as `shards` collectives, shard i > 0 goes to CPU helper i - 1
+  // so shards are progressed by different threads.
+  void enqueue_sharded_collective(
+      std::unique_ptr<WorkData> data,
+      c10::intrusive_ptr<WorkUCC> work,
+      ucc_coll_args_t& coll,
+      size_t element_size,
+      size_t shards);
+  // Creates TORCH_UCC_CPU_HELPERS helper communicators, collective over
+  // the group, called on first sharded collective.
+  void init_cpu_helpers();
+  struct cpu_helper_t {
+    std::shared_ptr<torch_ucc_oob_coll_info_t> oob;
+    std::shared_ptr<CommPG> comm;
+    ucc_team_h team{nullptr};
+  };
+  std::once_flag cpu_helpers_flag;
+  // own UCX worker, UCC context and progress thread each
+  std::vector<cpu_helper_t> cpu_helpers;
+#ifdef USE_CUDA
+  // Node local and cross node teams of TORCH_UCC_HIER_ALLREDUCE_THRESHOLD,
+  // created on the communicator of the group. enabled stays false unless
+  // there are several nodes with the same number of ranks each.
+  struct hier_teams_t {
+    bool enabled = false;
+    int node = 0;
+    int num_nodes = 1;
+    int local_rank = 0;
+    int local_size = 1;
+    std::shared_ptr<torch_ucc_oob_coll_info_t> intra_oob;
+    std::shared_ptr<torch_ucc_oob_coll_info_t> inter_oob;
+    // ranks on this node, ranks with the same local rank on all nodes
+    ucc_team_h intra{nullptr};
+    ucc_team_h inter{nullptr};
+  };
+  std::once_flag hier_flag;
+  hier_teams_t hier;
+  // Groups ranks by hostname or TORCH_UCC_HIER_LOCAL_SIZE and creates the
+  // teams, collective over the group, called on first large allreduce.
+  void init_hier_teams();
+  // True if allreduce coll on tensors goes through hierarchical teams.
+  bool use_hier_allreduce(
+      const ucc_coll_args_t& coll,
+      const std::vector<at::Tensor>& tensors);
+  // Posts in-place allreduce coll on buffer of `like` as reduce_scatter
+  // within the node, allreduce across nodes and allgather within the node,
+  // each phase gets its own work and event.
+  void enqueue_hier_allreduce(
+      std::unique_ptr<WorkData> data,
+      c10::intrusive_ptr<WorkUCC> work,
+      ucc_coll_args_t& coll,
+      const at::Tensor& like);
+
+  // CUDA graph capture. Every captured collective owns an event taken from
+  // a stock created outside capture and parks its progress entry until
+  // capture is over, so neither the event pool nor the progress thread is
+  // touched while the stream captures. Events are never reused, works of
+  // different graphs don't share them.
+  static constexpr size_t kCaptureEvents = 64;
+  std::vector<std::unique_ptr<at::cuda::CUDAEvent>> capture_events;
+  // set when the stock was used by a capture and has to be refilled
+  std::atomic<bool> refill_capture_events{false};
+  std::mutex capture_mutex;
+  std::vector<std::shared_ptr<ProgressEntry>> captured_entries;
+  std::atomic<bool> has_captured{false};
+
+  // True if current stream of dev is being captured.
+  bool is_capturing(c10::Device dev);
+  // Takes event for a captured collective from the stock, a capture posting
+  // more than kCaptureEvents collectives creates the rest while capturing.
+  std::unique_ptr<at::cuda::CUDAEvent> getCaptureEvent();
+  // Tops the stock up to kCaptureEvents, called outside capture.
+  void refillCaptureEvents();
+  // Hands parked entries of captured collectives over to the progress thread.
+  void submitCapturedEntries();
+#endif
+  std::mutex staging_mutex;
+  std::unordered_map<std::string, std::shared_ptr<StagingBuffer>>
+      staging_buffers;
+  // set with TORCH_UCC_MEMORY_SAVING, replaces staging_buffers
+  std::shared_ptr<BufferPool> buffer_pool;
+
+  // Returns flat buffer of at least numel elements for tensors of given
+  // device and dtype, buffer is marked in use. Buffers of different purpose
+  // are cached separately so one collective can use several. With
+  // TORCH_UCC_MEMORY_SAVING every call takes its own buffer from
+  // buffer_pool, returned once the caller drops it.
+  std::shared_ptr<StagingBuffer> get_staging_buffer(
+      const at::Tensor& like,
+      int64_t numel,
+      const std::string& purpose = "");
+#ifdef USE_CUDA
+  std::mutex compression_mutex;
+  // TORCH_UCC_COMPRESSION error feedback state, keyed by bucket and size
+  std::unordered_map<std::string, at::Tensor> compression_residuals;
+
+  // Returns float residual of numel elements for bucket, zeroed on first
+  // use. Undefined if error feedback is disabled or bucket is -1.
+  at::Tensor get_compression_residual(
+      const at::Tensor& buffer,
+      int64_t bucket,
+      int64_t numel);
+  // Float32 reductions sent in TORCH_UCC_COMPRESSION type, inputs are cast
+  // on the internal stream before the collective and results cast back after.
+  c10::intrusive_ptr<ProcessGroup::Work> allreduce_compressed(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts);
+  c10::intrusive_ptr<ProcessGroup::Work> reduce_scatter_compressed(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts);
+#endif
 };
 
 class CommPG {
@@ -336,29 +892,89 @@ class CommPG {
   std::shared_ptr<torch_ucc_oob_coll_info_t> oob;
   CommUCX ucx_comm;
   CommUCC ucc_comm;
+  // only used to sleep on condvars, submissions don't take it
   std::mutex mutex;
   std::thread progress_thread;
   std::condition_variable queue_produce_cv;
   std::condition_variable queue_consume_cv;
-  std::deque<std::shared_ptr<ProcessGroupUCC::ProgressEntry>> progress_queue;
-  bool stop_progress_loop;
-  bool collective_inprogress;
+  BoundedMPSCQueue<std::shared_ptr<ProcessGroupUCC::ProgressEntry>>
+      progress_queue;
+  std::atomic<bool> stop_progress_loop;
+  // requests submitted and not finalized yet
+  std::atomic<size_t> outstanding_requests;
+  // threads waiting for outstanding_requests to drop to zero
+  std::atomic<int> drain_waiters;
+  std::atomic<int> progress_thread_state;
   torch_ucc_phase_t finalize_phase;
 
+  struct team_cache_entry_t {
+    ucc_team_h team;
+    std::shared_ptr<torch_ucx_eps_t> eps;
+    // group that created the team, its store is used for teardown
+    std::shared_ptr<torch_ucc_oob_coll_info_t> oob;
+    int refs;
+  };
+  std::mutex team_cache_mutex;
+  // keyed by process ids of team ranks in rank order and device
+  std::unordered_map<std::string, team_cache_entry_t> team_cache;
+
+#ifdef TORCH_UCX_MEMH_CACHE
+  struct memh_cache_entry_t {
+    std::shared_ptr<torch_ucx_memh_t> memh;
+    std::list<uintptr_t>::iterator lru;
+  };
+  std::mutex memh_mutex;
+  // keyed by segment base address
+  std::map<uintptr_t, memh_cache_entry_t> memh_cache;
+  // segment base addresses, most recently used first
+  std::list<uintptr_t> memh_lru;
+  // Address ranges released by the allocator since the last lookup. Filled
+  // from allocator trace callbacks, which run under the allocator lock, so
+  // it has its own mutex that is never held while calling the allocator.
+  std::mutex memh_freed_mutex;
+  std::vector<std::pair<uintptr_t, size_t>> memh_freed;
+  // drops cached registrations overlapping the range, memh_mutex held
+  void memh_cache_erase(uintptr_t base, size_t size);
+#endif
+
+  // hands entry to progress thread, deferred to groupEnd inside a group
+  void submit(
+      std::shared_ptr<ProcessGroupUCC::ProgressEntry> entry,
+      const c10::intrusive_ptr<ProcessGroupUCC::WorkUCC>& work);
+  // True if operation of size bytes should be progressed by posting thread,
+  // only while progress thread has nothing in flight.
+  bool use_eager(size_t size);
+  // Progresses collective on the calling thread for TORCH_UCC_EAGER_SPIN
+  // iterations, finalizes and returns true if it completed.
+  bool progress_eager(ProcessGroupUCC::ProgressEntry& entry);
+  // Same for p2p entries completed by UCX callbacks.
+  void ucx_progress_eager(ProcessGroupUCC::ProgressEntry& entry);
+  // wakes progress thread up if it sleeps, skipped when it is spinning
+  void ring_doorbell();
+  void request_done();
+
  public:
   c10::DeviceIndex cuda_device_index;
+  // With TORCH_UCC_PROGRESS_CPU progress thread of CPU helper i is pinned to
+  // the i-th CPU after it, helper_index is 0 for main communicators.
   CommPG(const c10::intrusive_ptr<ProcessGroupUCCLogger>& logger,
       std::shared_ptr<torch_ucc_oob_coll_info_t> oob,
-      c10::Device dev, bool is_health_check);
+      c10::Device dev, bool is_health_check, int helper_index = 0);
 
   ~CommPG();
 
+  // Exchanges worker addresses with a single OOB allgather, endpoints are
+  // created right away only if lazy is false.
   void ucx_connect_eps(
-      std::vector<ucp_ep_h>& eps,
-      std::shared_ptr<torch_ucc_oob_coll_info_t> oob);
+      torch_ucx_eps_t& eps,
+      std::shared_ptr<torch_ucc_oob_coll_info_t> oob,
+      bool lazy = true);
+
+  // Returns endpoint to rank, creating it on first use.
+  ucp_ep_h ucx_get_ep(torch_ucx_eps_t& eps, int rank);
 
   void ucx_disconnect_eps(
-      std::vector<ucp_ep_h>& eps,
+      torch_ucx_eps_t& eps,
       std::shared_ptr<torch_ucc_oob_coll_info_t> oob);
 
   void ucc_create_team(
@@ -367,25 +983,63 @@ class CommPG {
 
   void ucc_destroy_team(ucc_team_h& team);
 
+  // Returns team and endpoints of an earlier group spanning the same
+  // processes on the same device if all ranks still have it, creates new ones
+  // otherwise.
+  void ucc_acquire_team(
+      ucc_team_h& team,
+      std::shared_ptr<torch_ucx_eps_t>& eps,
+      std::shared_ptr<torch_ucc_oob_coll_info_t> oob,
+      c10::Device dev);
+
+  // Drops team reference, team and endpoints are destroyed with the last one.
+  void ucc_release_team(
+      ucc_team_h& team,
+      std::shared_ptr<torch_ucx_eps_t>& eps,
+      std::shared_ptr<torch_ucc_oob_coll_info_t> oob);
+
+  // blocks until all submitted requests are finalized
+  void wait_for_drain();
+
+  // submits entries with a single wakeup of progress thread, counted if
+  // they were already added to outstanding requests by a deferred submit
+  void submit_batch(
+      std::vector<std::shared_ptr<ProcessGroupUCC::ProgressEntry>>& entries,
+      bool counted = false);
+
+  // Wraps entry returned by send_nb/recv_nb into work, entries are
+  // finalized by UCX completion callbacks and progress thread only drives UCX
+  // worker for them.
   c10::intrusive_ptr<ProcessGroup::Work> enqueue_p2p(
       OpType opType,
-      ucc_coll_req_h request,
-      const char* prof_title);
+      std::shared_ptr<ProcessGroupUCC::ProgressEntry> entry,
+      const char* prof_title,
+      std::chrono::milliseconds timeout);
 
 #ifdef USE_CUDA
+  // With captured set the entry is returned there instead of being submitted
+  // and work completes on host right away, the collective is in the graph.
   void enqueue_cuda_collective(
       std::unique_ptr<ProcessGroupUCC::WorkData> data,
       c10::intrusive_ptr<ProcessGroupUCC::WorkUCC> work,
       ucc_coll_args_t& coll,
       ucc_team_h team,
-      ucc_ee_h ee);
+      ucc_ee_h ee,
+      std::shared_ptr<ProcessGroupUCC::PersistentCollective> persistent =
+          nullptr,
+      std::shared_ptr<ProcessGroupUCC::ProgressEntry>* captured = nullptr);
 #endif
 
+  // size is the message size in bytes, collectives below
+  // TORCH_UCC_EAGER_THRESHOLD may be completed on the calling thread.
   void enqueue_collective(
       std::unique_ptr<ProcessGroupUCC::WorkData> data,
       c10::intrusive_ptr<ProcessGroupUCC::WorkUCC> work,
       ucc_coll_args_t& coll,
-      ucc_team_h team);
+      ucc_team_h team,
+      std::shared_ptr<ProcessGroupUCC::PersistentCollective> persistent =
+          nullptr,
+      size_t size = SIZE_MAX);
 
   static std::shared_ptr<CommPG> get_comm(
       uint32_t& id,
@@ -396,19 +1050,31 @@ class CommPG {
 
   void progress_loop();
 
-  ucc_coll_req_h send_nb(
+#ifdef TORCH_UCX_MEMH_CACHE
+  // Returns registration of the caching allocator segment holding the
+  // buffer, null if caching is disabled or the buffer doesn't qualify.
+  std::shared_ptr<torch_ucx_memh_t>
+  ucx_get_memh(void* ptr, size_t size, ucs_memory_type_t mtype);
+  // Records range released by the allocator for all communicators, their
+  // registrations overlapping it are dropped on next lookup.
+  static void memh_segment_freed(uintptr_t base, size_t size);
+#endif
+
+  std::shared_ptr<ProcessGroupUCC::ProgressEntry> send_nb(
       ucp_ep_h ep,
       void* data,
       ucs_memory_type_t mtype,
       size_t size,
-      ucp_tag_t ucp_tag);
+      ucp_tag_t ucp_tag,
+      std::shared_ptr<ProcessGroupUCCMetrics> metrics = nullptr);
 
-  ucc_coll_req_h recv_nb(
+  std::shared_ptr<ProcessGroupUCC::ProgressEntry> recv_nb(
       void* data,
       ucs_memory_type_t mtype,
       size_t size,
       ucp_tag_t ucp_tag,
-      ucp_tag_t ucp_tag_mask);
+      ucp_tag_t ucp_tag_mask,
+      std::shared_ptr<ProcessGroupUCCMetrics> metrics = nullptr);
 };
 
 } // namespace c10d
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include "torch_ucc.hpp"
+
+#include <string>
+#include <vector>
+
+namespace c10d {
+
+// Names of operations accepted by runBenchmark.
+std::vector<std::string> benchmarkOps();
+
+// Times `iters` back to back calls of operation `op` on pg after `warmup`
+// untimed ones, issuing and waiting from C++ so Python overhead doesn't skew
+// small message latency. size is the buffer size in bytes as in nccl-tests:
+// the whole buffer for allreduce, broadcast and reduce, the buffer all per
+// rank pieces are gathered into or scattered from for the others. Returns
+// per iteration latency of this rank in microseconds, send/recv reports half
+// of the round trip between rank pairs. Collective over pg.
+std::vector<double> runBenchmark(
+    ProcessGroupUCC& pg,
+    const std::string& op,
+    int64_t size,
+    c10::Device dev,
+    int warmup,
+    int iters);
+
+} // namespace c10d
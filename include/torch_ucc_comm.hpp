@@ -125,7 +125,10 @@ class TORCH_API ProcessGroupUCCLogger : public torch::CustomClassHolder {
     local_phase = phase;
   }
 
-  void initCommsTracer();
+  // Starts streaming comms trace of the group to
+  // <dir>/rank<rank>_<n>.bin, n counts traced groups of the process.
+  void initCommsTracer(int rank, int world_size);
+  // Writes out remaining records and closes the trace.
   void flushComms(int rank, int world_size);
   std::shared_ptr<CommTraceLogger> trace_generator = nullptr;
 
@@ -133,6 +136,8 @@ class TORCH_API ProcessGroupUCCLogger : public torch::CustomClassHolder {
   std::string log_prefix;
   torch_ucc_phase_t local_phase = TORCH_UCC_UNKNOWN;
   bool initialized_CommTraceLogger = false;
+  std::string trace_dirname;
+  std::string trace_filename;
 };
 
 struct torch_ucc_oob_coll_info_t {
@@ -140,10 +145,13 @@ struct torch_ucc_oob_coll_info_t {
   uint32_t comm_id;
   int rank;
   int size;
-  void* rbuf;
-  size_t msglen;
+  // number of OOB allgathers started on this object, makes their keys unique
+  // so no rendezvous is needed before the next one
+  uint64_t oob_seq = 0;
+  // separates keys of helper communicators sharing the store and comm_id
+  std::string key_prefix;
   std::string getKey(std::string key) {
-    return std::to_string(comm_id) + key;
+    return key_prefix + std::to_string(comm_id) + key;
   }
 };
 
@@ -167,7 +175,8 @@ class CommUCX : public CommBase {
   void free_request(ucc_coll_req_h request) override;
   CommUCX(
       int comm_size,
-      const c10::intrusive_ptr<ProcessGroupUCCLogger>& logger);
+      const c10::intrusive_ptr<ProcessGroupUCCLogger>& logger,
+      bool enable_wakeup);
   ~CommUCX();
 };
 
@@ -196,4 +205,12 @@ ucc_status_t oob_allgather_test(void* req);
 
 ucc_status_t oob_allgather_free(void* req);
 
+// Blocking allgather of msglen bytes over the OOB callbacks above, throws on
+// store failure.
+void oob_allgather_sync(
+    torch_ucc_oob_coll_info_t* info,
+    void* sbuf,
+    void* rbuf,
+    size_t msglen);
+
 } // namespace c10d
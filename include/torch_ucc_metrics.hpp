@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <c10d/ProcessGroup.hpp>
+
+namespace c10d {
+
+inline int64_t torch_ucc_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Latency and bandwidth of completed operations of a process group,
+// aggregated per op type and message size bucket. Enabled with
+// TORCH_UCC_ENABLE_METRICS, operations are recorded by the thread finalizing
+// them, mostly the progress thread, so the lock is rarely contended.
+class ProcessGroupUCCMetrics {
+ public:
+  // latency bucket i counts operations that took less than 2^i us
+  static constexpr int kLatencyBuckets = 32;
+
+  // Operation description and timestamps taken on the posting thread, in
+  // steady clock nanoseconds.
+  struct Sample {
+    OpType op = OpType::UNKNOWN;
+    uint64_t bytes = 0;
+    // ProcessGroupUCC was called
+    int64_t enqueue_ns = 0;
+    // request was posted to UCC or UCX
+    int64_t post_ns = 0;
+  };
+
+  struct Cell {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    // phases summed over operations, in nanoseconds
+    // enqueue -> post: argument setup, staging copies, request init
+    uint64_t setup_ns = 0;
+    // post -> picked up by progress thread
+    uint64_t queue_ns = 0;
+    // picked up -> completion detected
+    uint64_t inflight_ns = 0;
+    // completion detected -> work completed
+    uint64_t complete_ns = 0;
+    uint64_t max_ns = 0;
+    std::array<uint64_t, kLatencyBuckets> latency{};
+  };
+
+  // keyed by op type and size bucket
+  using Snapshot = std::map<std::pair<OpType, int>, Cell>;
+
+  // Bucket b > 0 holds messages of [2^(b-1), 2^b) bytes, 0 holds empty ones.
+  static int size_bucket(uint64_t bytes) {
+    return bytes == 0 ? 0 : 64 - __builtin_clzll(bytes);
+  }
+
+  // progress_ns is 0 if progress thread never saw the operation, i.e. it
+  // completed on the posting thread or from a UCX callback before that.
+  void record(
+      const Sample& s,
+      int64_t progress_ns,
+      int64_t finalize_ns,
+      int64_t done_ns) {
+    const int64_t picked_ns =
+        progress_ns ? std::min(progress_ns, finalize_ns) : s.post_ns;
+    const uint64_t total_ns = done_ns - s.enqueue_ns;
+    const uint64_t total_us = total_ns / 1000;
+    const int lat_bucket = std::min(
+        total_us == 0 ? 0 : 64 - __builtin_clzll(total_us),
+        kLatencyBuckets - 1);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& cell = cells_[std::make_pair(s.op, size_bucket(s.bytes))];
+    cell.count++;
+    cell.bytes += s.bytes;
+    cell.setup_ns += s.post_ns - s.enqueue_ns;
+    cell.queue_ns += picked_ns - s.post_ns;
+    cell.inflight_ns += finalize_ns - picked_ns;
+    cell.complete_ns += done_ns - finalize_ns;
+    cell.max_ns = std::max(cell.max_ns, total_ns);
+    cell.latency[lat_bucket]++;
+  }
+
+  Snapshot snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cells_;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cells_.clear();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  Snapshot cells_;
+};
+
+} // namespace c10d
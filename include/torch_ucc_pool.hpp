@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace c10d {
+
+// Free lists of small fixed size blocks used for objects created on every
+// collective (work objects, progress entries, work data). Each thread takes
+// and returns blocks through its own lists without locking. Blocks move
+// between threads in batches through a shared depot, objects are usually
+// created by the posting thread and released by the progress thread. The
+// depot is process wide and never destroyed since work objects can outlive
+// the process group and communicator that created them.
+class SlabPool {
+ public:
+  static constexpr size_t kSizeClass = 64;
+  static constexpr size_t kNumClasses = 16;
+  // cached blocks per size class in the depot, extra blocks go back to the
+  // system
+  static constexpr size_t kMaxCached = 4096;
+  // blocks moved between a thread and the depot at once, a thread keeps
+  // less than twice as many per size class
+  static constexpr size_t kBatch = 64;
+
+  static void* allocate(size_t size) {
+    size_t cls = size_class(size);
+    if (cls >= kNumClasses) {
+      return ::operator new(size);
+    }
+    if (!thread_exited()) {
+      auto& blocks = thread_cache().blocks[cls];
+      if (blocks.empty()) {
+        instance().take(cls, blocks);
+      }
+      if (!blocks.empty()) {
+        void* p = blocks.back();
+        blocks.pop_back();
+        return p;
+      }
+    }
+    return ::operator new((cls + 1) * kSizeClass);
+  }
+
+  static void deallocate(void* p, size_t size) noexcept {
+    size_t cls = size_class(size);
+    if (cls >= kNumClasses) {
+      ::operator delete(p);
+      return;
+    }
+    if (thread_exited()) {
+      // released by thread local destructors after the cache of this
+      // thread is gone
+      instance().give(cls, &p, 1);
+      return;
+    }
+    auto& blocks = thread_cache().blocks[cls];
+    blocks.push_back(p);
+    if (blocks.size() >= 2 * kBatch) {
+      instance().give(cls, blocks.data() + blocks.size() - kBatch, kBatch);
+      blocks.resize(blocks.size() - kBatch);
+    }
+  }
+
+ private:
+  struct FreeList {
+    std::mutex mutex;
+    std::vector<void*> blocks;
+  };
+
+  struct ThreadCache {
+    ThreadCache() {
+      // never grows, deallocate doesn't allocate
+      for (auto& b : blocks) {
+        b.reserve(2 * kBatch);
+      }
+    }
+    ~ThreadCache() {
+      thread_exited() = true;
+      for (size_t cls = 0; cls < kNumClasses; cls++) {
+        instance().give(cls, blocks[cls].data(), blocks[cls].size());
+      }
+    }
+    std::vector<void*> blocks[kNumClasses];
+  };
+
+  static size_t size_class(size_t size) {
+    return (size + kSizeClass - 1) / kSizeClass - 1;
+  }
+
+  static SlabPool& instance() {
+    // intentionally leaked, see above
+    static SlabPool* pool = new SlabPool();
+    return *pool;
+  }
+
+  static ThreadCache& thread_cache() {
+    thread_local ThreadCache cache;
+    return cache;
+  }
+
+  // trivially destructible, still valid while thread_cache is destroyed
+  static bool& thread_exited() {
+    thread_local bool exited = false;
+    return exited;
+  }
+
+  // moves up to kBatch blocks of the depot to the thread's list
+  void take(size_t cls, std::vector<void*>& blocks) {
+    auto& fl = free_lists_[cls];
+    std::lock_guard<std::mutex> lock(fl.mutex);
+    const size_t n = std::min(kBatch, fl.blocks.size());
+    blocks.insert(blocks.end(), fl.blocks.end() - n, fl.blocks.end());
+    fl.blocks.resize(fl.blocks.size() - n);
+  }
+
+  void give(size_t cls, void* const* p, size_t n) noexcept {
+    auto& fl = free_lists_[cls];
+    std::lock_guard<std::mutex> lock(fl.mutex);
+    for (size_t i = 0; i < n; i++) {
+      if (fl.blocks.size() < kMaxCached) {
+        fl.blocks.push_back(p[i]);
+      } else {
+        ::operator delete(p[i]);
+      }
+    }
+  }
+
+  FreeList free_lists_[kNumClasses];
+};
+
+// Base class routing operator new/delete of derived classes to SlabPool,
+// works with c10::make_intrusive and std::unique_ptr.
+struct SlabAllocated {
+  static void* operator new(size_t size) {
+    return SlabPool::allocate(size);
+  }
+  static void operator delete(void* p, size_t size) noexcept {
+    SlabPool::deallocate(p, size);
+  }
+};
+
+// Allocator for std::allocate_shared, places object and control block in a
+// single pooled block.
+template <typename T>
+struct SlabAllocator {
+  using value_type = T;
+  SlabAllocator() = default;
+  template <typename U>
+  SlabAllocator(const SlabAllocator<U>&) {}
+  T* allocate(size_t n) {
+    return static_cast<T*>(SlabPool::allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n) noexcept {
+    SlabPool::deallocate(p, n * sizeof(T));
+  }
+  template <typename U>
+  bool operator==(const SlabAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const SlabAllocator<U>&) const {
+    return false;
+  }
+};
+
+// Reuses per-rank length/offset arrays of v-collectives, arrays are keyed by
+// group size so they are allocated once per size and recycled afterwards.
+class CountsPool {
+ public:
+  static std::vector<uint64_t> acquire(size_t size) {
+    if (size == 0) {
+      return std::vector<uint64_t>();
+    }
+    auto& pool = instance();
+    {
+      std::lock_guard<std::mutex> lock(pool.mutex_);
+      auto it = pool.arrays_.find(size);
+      if (it != pool.arrays_.end() && !it->second.empty()) {
+        std::vector<uint64_t> v = std::move(it->second.back());
+        it->second.pop_back();
+        return v;
+      }
+    }
+    return std::vector<uint64_t>(size);
+  }
+
+  static void release(std::vector<uint64_t>& v) {
+    if (v.empty()) {
+      return;
+    }
+    auto& pool = instance();
+    std::lock_guard<std::mutex> lock(pool.mutex_);
+    auto& arrays = pool.arrays_[v.size()];
+    if (arrays.size() < SlabPool::kMaxCached) {
+      arrays.push_back(std::move(v));
+    }
+  }
+
+ private:
+  static CountsPool& instance() {
+    static CountsPool* pool = new CountsPool();
+    return *pool;
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<size_t, std::vector<std::vector<uint64_t>>> arrays_;
+};
+
+} // namespace c10d
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace c10d {
+
+// Bounded lock-free queue with many producers and a single consumer.
+// Each cell carries a sequence number telling whether it is free for the
+// producer that claimed its position or holds a value ready for the consumer
+// (D. Vyukov's bounded queue, consumer side simplified to a single thread).
+template <typename T>
+class BoundedMPSCQueue {
+ public:
+  explicit BoundedMPSCQueue(size_t capacity) : head_(0), tail_(0) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    cells_ = std::unique_ptr<Cell[]>(new Cell[size]);
+    for (size_t i = 0; i < size; i++) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedMPSCQueue(const BoundedMPSCQueue&) = delete;
+  BoundedMPSCQueue& operator=(const BoundedMPSCQueue&) = delete;
+
+  // Returns false if the queue is full, value is moved only on success.
+  // Safe to call from any thread.
+  bool try_push(T& value) {
+    Cell* cell;
+    size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+      if (dif == 0) {
+        if (head_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(value);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer thread only.
+  bool try_pop(T& value) {
+    Cell* cell = &cells_[tail_ & mask_];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(tail_ + 1) < 0) {
+      return false;
+    }
+    value = std::move(cell->data);
+    cell->data = T();
+    cell->seq.store(tail_ + mask_ + 1, std::memory_order_release);
+    tail_++;
+    return true;
+  }
+
+  // Consumer thread only.
+  bool empty() const {
+    const Cell* cell = &cells_[tail_ & mask_];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)(tail_ + 1) < 0;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) size_t tail_;
+};
+
+} // namespace c10d
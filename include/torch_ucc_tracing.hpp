@@ -9,6 +9,14 @@
 #pragma once
 
 #include "torch_ucc_comm.hpp"
+#include "torch_ucc_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
 
 namespace c10d {
 
@@ -26,15 +34,96 @@ namespace c10d {
     }                                                                          \
   } while (0)
 
+// Trace files start with this header followed by fixed size records,
+// tools/ucc_trace_converter.py renders them as JSON.
+#define TORCH_UCC_TRACE_MAGIC "UCCTRACE"
+#define TORCH_UCC_TRACE_VERSION 1
+
+struct torch_ucc_trace_header_t {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  int32_t rank;
+  int32_t world_size;
+};
+
+enum torch_ucc_trace_record_type_t : uint8_t {
+  TORCH_UCC_TRACE_COMM,
+  // alltoallv splits of the preceding comm record with the same seqnum,
+  // split over as many records as needed
+  TORCH_UCC_TRACE_IN_SPLIT,
+  TORCH_UCC_TRACE_OUT_SPLIT,
+};
+
+#define TORCH_UCC_TRACE_NAME_LEN 24
+#define TORCH_UCC_TRACE_SPLITS_PER_RECORD 8
+
+struct torch_ucc_trace_record_t {
+  uint8_t type;
+  // c10::ScalarType and c10::DeviceType of output, -1 if no tensors
+  int8_t dtype;
+  int8_t dev_type;
+  // valid entries in splits of split records
+  uint8_t num_splits;
+  int32_t root;
+  uint64_t seqnum;
+  union {
+    struct {
+      int64_t start_ns;
+      uint64_t req;
+      int64_t in_size;
+      int64_t out_size;
+      int32_t world_size;
+      int32_t reserved;
+      char name[TORCH_UCC_TRACE_NAME_LEN];
+    } comm;
+    int64_t splits[TORCH_UCC_TRACE_SPLITS_PER_RECORD];
+  };
+};
+
+static_assert(sizeof(torch_ucc_trace_record_t) == 80, "trace record layout");
+
 // interfaces to collect communication traces
+// Records are pushed to a bounded lock-free ring and written to the trace
+// file by a background thread, records are dropped if the ring is full.
 class TORCH_API CommTraceLogger : public torch::CustomClassHolder {
  private:
-  std::vector<std::string> comms_trace_;
+  BoundedMPSCQueue<torch_ucc_trace_record_t> records_;
   std::vector<std::string> curBlocks_;                  /* unused */
   std::vector<int64_t> curOutSplitSizes_;
   std::vector<int64_t> curInSplitSizes_;
   int curRoot_ = -1;
-  unsigned long seqnum = 0;
+  std::atomic<uint64_t> seqnum{0};
+  std::atomic<uint64_t> dropped_{0};
+  FILE* file_ = nullptr;
+  std::thread flush_thread_;
+  std::mutex flush_mutex_;
+  std::condition_variable flush_cv_;
+  bool stop_ = false;
+
+  void push(torch_ucc_trace_record_t& record);
+  void pushSplits(
+      torch_ucc_trace_record_type_t type,
+      uint64_t seq,
+      const std::vector<int64_t>& splits);
+  // writes all queued records to file, flush thread only
+  void drain();
+  void flushLoop(std::chrono::milliseconds interval);
+
+ public:
+  explicit CommTraceLogger(size_t capacity);
+  ~CommTraceLogger();
+  // Opens trace file and starts flushing records to it every interval.
+  bool open(
+      const std::string& filename,
+      int rank,
+      int world_size,
+      std::chrono::milliseconds interval);
+  // Stops flush thread, writes remaining records and closes the file.
+  void close();
+  uint64_t dropped() const {
+    return dropped_;
+  }
 
  public:
   void setCurBlock(const std::string& name);            /* unused */
@@ -53,10 +142,6 @@ class TORCH_API CommTraceLogger : public torch::CustomClassHolder {
       const int world_size = -1,
       const std::vector<at::Tensor>& inputTensors = {},
       const std::vector<at::Tensor>& outputTensor = {});
-  // return collected comms traces
-  std::vector<std::string>& getCommsTrace() {
-    return comms_trace_;
-  }
 };
 
 } // namespace c10d
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <c10/core/DeviceType.h>
+
+namespace c10d {
+
+// Operations with several equivalent implementations, choice 0 is what the
+// static configuration does by default.
+enum torch_ucc_tune_op_t {
+  // 0 allgather through staging buffer, 1 allgatherv into output tensors
+  TORCH_UCC_TUNE_ALLGATHER = 0,
+  // 0 single request, 1 TORCH_UCC_CHUNK_SIZE chunks or CPU helper shards
+  TORCH_UCC_TUNE_CHUNKING,
+  // 0 flat allreduce, 1 hierarchical allreduce
+  TORCH_UCC_TUNE_HIER,
+  TORCH_UCC_TUNE_LAST
+};
+
+const char* torch_ucc_tune_op_name(torch_ucc_tune_op_t op);
+
+// Per message size choice of implementation for every tuned operation,
+// filled by TORCH_UCC_TUNE benchmarks or loaded from TORCH_UCC_TUNE_FILE.
+// Rows are written once before the device is marked ready and only read
+// afterwards, so lookups on the posting path take no lock.
+class ProcessGroupUCCTuneTable {
+ public:
+  // bucket b > 0 holds messages of [2^(b-1), 2^b) bytes, as metrics do
+  static constexpr int kBuckets = 48;
+  using Row = std::array<int8_t, kBuckets>;
+  using Rows = std::array<Row, TORCH_UCC_TUNE_LAST>;
+
+  ProcessGroupUCCTuneTable();
+
+  static int size_bucket(uint64_t bytes) {
+    const int b = bytes == 0 ? 0 : 64 - __builtin_clzll(bytes);
+    return b < kBuckets ? b : kBuckets - 1;
+  }
+
+  // Tuned choice of op for bytes long messages on dev, -1 if dev isn't
+  // tuned and the static configuration applies.
+  int choice(torch_ucc_tune_op_t op, c10::DeviceType dev, uint64_t bytes)
+      const {
+    if (forced_op_ == op) {
+      return forced_choice_;
+    }
+    const int d = device_index(dev);
+    if (!ready_[d].load(std::memory_order_acquire)) {
+      return -1;
+    }
+    return rows_[d][op][size_bucket(bytes)];
+  }
+
+  // True once for every device, the caller loads or tunes it.
+  bool start(c10::DeviceType dev) {
+    return !started_[device_index(dev)].exchange(true);
+  }
+  bool started(c10::DeviceType dev) const {
+    return started_[device_index(dev)].load(std::memory_order_relaxed);
+  }
+  bool ready(c10::DeviceType dev) const {
+    return ready_[device_index(dev)].load(std::memory_order_acquire);
+  }
+  const Rows& rows(c10::DeviceType dev) const {
+    return rows_[device_index(dev)];
+  }
+  void set_rows(c10::DeviceType dev, const Rows& rows);
+
+  // While benchmarking candidates op takes choice regardless of the table.
+  void force(torch_ucc_tune_op_t op, int choice) {
+    forced_choice_ = choice;
+    forced_op_ = op;
+  }
+  void unforce() {
+    forced_op_ = TORCH_UCC_TUNE_LAST;
+  }
+
+  // Row of key in tuning file at path, false if the file or key is missing.
+  static bool load(const std::string& path, const std::string& key, Rows& rows);
+  // Replaces rows of key in tuning file at path, other keys are kept.
+  static void save(
+      const std::string& path,
+      const std::string& key,
+      const Rows& rows);
+
+ private:
+  static int device_index(c10::DeviceType dev) {
+    return dev == c10::DeviceType::CUDA ? 1 : 0;
+  }
+  std::array<Rows, 2> rows_;
+  std::array<std::atomic<bool>, 2> started_;
+  std::array<std::atomic<bool>, 2> ready_;
+  std::atomic<int> forced_op_{TORCH_UCC_TUNE_LAST};
+  std::atomic<int> forced_choice_{-1};
+};
+
+} // namespace c10d
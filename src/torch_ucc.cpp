@@ -9,15 +9,35 @@
  */
 
 #include "torch_ucc.hpp"
+#include "torch_ucc_bench.hpp"
 #include "torch_ucc_comm.hpp"
 #include "torch_ucc_tracing.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <memory>
 #include <list>
+#include <numeric>
+
+#include <poll.h>
+#include <random>
+#include <unistd.h>
+
+#ifdef USE_CUDA
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/cuda/CUDAException.h>
+#endif
 
 namespace c10d {
 
 namespace {
 constexpr int64_t kBusyWaitMillis = 10;
+// smallest size class of TORCH_UCC_MEMORY_SAVING staging buffers
+constexpr int64_t kMinPooledBytes = 4096;
+// released ranges kept for a registration cache before they are collapsed
+// into one covering the whole address space
+constexpr size_t kMaxFreedRanges = 64;
 
 const std::map<c10::DeviceType, ucs_memory_type_t> ucs_mtype_map = {
     {c10::kCPU, UCS_MEMORY_TYPE_HOST},
@@ -108,6 +128,28 @@ ucc_reduction_op_t to_ucc_reduceOp(
   }
 }
 
+enum torch_ucc_wait_mode_t {
+  // busy poll completion, lowest latency
+  TORCH_UCC_WAIT_SPIN,
+  // poll completion and yield the CPU in between
+  TORCH_UCC_WAIT_YIELD,
+  // poll for wait_spin_usec, then sleep until progress thread completes work
+  TORCH_UCC_WAIT_PARK,
+};
+
+std::map<std::string, torch_ucc_wait_mode_t> torch_ucc_wait_mode_map = {
+    {"spin", TORCH_UCC_WAIT_SPIN},
+    {"yield", TORCH_UCC_WAIT_YIELD},
+    {"park", TORCH_UCC_WAIT_PARK},
+};
+
+// wire types of TORCH_UCC_COMPRESSION, Undefined leaves payloads as is
+std::map<std::string, at::ScalarType> torch_ucc_compression_map = {
+    {"none", at::ScalarType::Undefined},
+    {"fp16", at::kHalf},
+    {"bf16", at::kBFloat16},
+};
+
 struct torch_ucc_config_t {
   std::once_flag flag;
   std::array<bool, 32> blocking_wait;
@@ -117,6 +159,35 @@ struct torch_ucc_config_t {
   bool shared_comm;
   bool use_allgatherv;
   bool enable_health_check;
+  int progress_spin_usec;
+  int progress_cpu;
+  int progress_queue_size;
+  bool persistent_coll;
+  int persistent_cache_size;
+  int64_t chunk_size;
+  bool fast_exit;
+  bool async_init;
+  bool team_cache;
+  torch_ucc_wait_mode_t wait_mode;
+  int wait_spin_usec;
+  int memh_cache_size;
+  int64_t memh_cache_min_size;
+  int64_t eager_threshold;
+  int eager_spin;
+  int cpu_helpers;
+  int64_t cpu_shard_size;
+  bool enable_metrics;
+  at::ScalarType compression;
+  bool compression_error_feedback;
+  int64_t hier_allreduce_threshold;
+  int hier_local_size;
+  bool tune;
+  std::string tune_file;
+  int64_t tune_max_size;
+  int alltoall_splits_cache;
+  bool memory_saving;
+  int64_t buffer_pool_size;
+  int64_t compression_min_size;
 } torch_ucc_config;
 
 std::map<std::string, std::string> torch_ucc_envs_map = {
@@ -137,8 +208,234 @@ std::map<std::string, std::string> torch_ucc_envs_map = {
     {"TORCH_UCC_SHARED_COMM", "1"},
     {"TORCH_UCC_USE_ALLGATHERV", "0"},
     {"TORCH_UCC_ENABLE_HEALTH_CHECK", "0"},
+    {"TORCH_UCC_PROGRESS_SPIN_USEC", "-1"},
+    {"TORCH_UCC_PROGRESS_CPU", "-1"},
+    {"TORCH_UCC_PROGRESS_QUEUE_SIZE", "1024"},
+    {"TORCH_UCC_PERSISTENT_COLL", "0"},
+    {"TORCH_UCC_PERSISTENT_CACHE_SIZE", "64"},
+    {"TORCH_UCC_CHUNK_SIZE", "0"},
+    {"TORCH_UCC_FAST_EXIT", "0"},
+    {"TORCH_UCC_ASYNC_INIT", "0"},
+    {"TORCH_UCC_TEAM_CACHE", "0"},
+    {"TORCH_UCC_WAIT_MODE", "spin"},
+    {"TORCH_UCC_WAIT_SPIN_USEC", "50"},
+    {"TORCH_UCC_MEMH_CACHE", "0"},
+    {"TORCH_UCC_MEMH_CACHE_MIN_SIZE", "65536"},
+    {"TORCH_UCC_EAGER_THRESHOLD", "0"},
+    {"TORCH_UCC_EAGER_SPIN", "100"},
+    {"TORCH_UCC_CPU_HELPERS", "0"},
+    {"TORCH_UCC_CPU_SHARD_SIZE", "16777216"},
+    {"TORCH_UCC_ENABLE_METRICS", "0"},
+    {"TORCH_UCC_COMPRESSION", "none"},
+    {"TORCH_UCC_COMPRESSION_ERROR_FEEDBACK", "0"},
+    {"TORCH_UCC_HIER_ALLREDUCE_THRESHOLD", "0"},
+    {"TORCH_UCC_HIER_LOCAL_SIZE", "0"},
+    {"TORCH_UCC_TUNE", "0"},
+    {"TORCH_UCC_TUNE_FILE", ""},
+    {"TORCH_UCC_TUNE_MAX_SIZE", "67108864"},
+    {"TORCH_UCC_ALLTOALL_SPLITS_CACHE", "16"},
+    {"TORCH_UCC_MEMORY_SAVING", "0"},
+    {"TORCH_UCC_BUFFER_POOL_SIZE", "268435456"},
+    {"TORCH_UCC_COMPRESSION_MIN_SIZE", "65536"},
+};
+
+// UCX p2p request context passed to completion callback as user data.
+struct torch_ucx_p2p_req_t : public SlabAllocated {
+  explicit torch_ucx_p2p_req_t(
+      std::shared_ptr<ProcessGroupUCC::ProgressEntry> entry)
+      : entry(std::move(entry)) {}
+  std::shared_ptr<ProcessGroupUCC::ProgressEntry> entry;
+  // filled by UCX if receive completes immediately
+  ucp_tag_recv_info_t info;
+#ifdef TORCH_UCX_MEMH_CACHE
+  // keeps registration alive until the operation completes
+  std::shared_ptr<torch_ucx_memh_t> memh;
+#endif
+};
+
+#ifdef TORCH_UCC_SEGMENT_EVENTS
+// process groups with cached requests on CUDA buffers
+std::mutex persistent_caches_mutex;
+std::vector<ProcessGroupUCC*> persistent_caches;
+
+// The allocator trace tracker can't be detached, it is attached once and
+// forwards segment free events to all caches.
+void segment_tracker_attach() {
+  static std::once_flag attached;
+  std::call_once(attached, []() {
+    c10::cuda::CUDACachingAllocator::attachAllocatorTraceTracker(
+        [](const c10::cuda::CUDACachingAllocator::TraceEntry& te) {
+          using Action = c10::cuda::CUDACachingAllocator::TraceEntry::Action;
+          // empty_cache, OOM retries and unmapped expandable segment pages
+          if (te.action_ == Action::SEGMENT_FREE ||
+              te.action_ == Action::SEGMENT_UNMAP) {
+#ifdef TORCH_UCX_MEMH_CACHE
+            CommPG::memh_segment_freed((uintptr_t)te.addr_, (size_t)te.size_);
+#endif
+            ProcessGroupUCC::persistent_segment_freed(
+                (uintptr_t)te.addr_, (size_t)te.size_);
+          }
+        });
+  });
+}
+
+bool ranges_overlap(
+    const std::vector<std::pair<uintptr_t, size_t>>& a,
+    const std::vector<std::pair<uintptr_t, size_t>>& b) {
+  for (const auto& x : a) {
+    for (const auto& y : b) {
+      if (x.first < y.first + y.second && y.first < x.first + x.second) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+#endif
+
+#ifdef TORCH_UCX_MEMH_CACHE
+// communicators with registration cache, notified of released segments
+std::mutex memh_caches_mutex;
+std::vector<CommPG*> memh_caches;
+
+// Registers communicator for segment free events.
+void memh_cache_attach(CommPG* comm) {
+  segment_tracker_attach();
+  std::lock_guard<std::mutex> lock(memh_caches_mutex);
+  memh_caches.push_back(comm);
+}
+
+void memh_cache_detach(CommPG* comm) {
+  std::lock_guard<std::mutex> lock(memh_caches_mutex);
+  memh_caches.erase(
+      std::remove(memh_caches.begin(), memh_caches.end(), comm),
+      memh_caches.end());
+}
+
+// Attaches cached registration of the buffer to request parameters.
+void set_memh(
+    CommPG* comm,
+    torch_ucx_p2p_req_t* req,
+    ucp_request_param_t& params,
+    void* data,
+    size_t size,
+    ucs_memory_type_t mtype) {
+  req->memh = comm->ucx_get_memh(data, size, mtype);
+  if (req->memh) {
+    params.op_attr_mask |= UCP_OP_ATTR_FIELD_MEMH;
+    params.memh = req->memh->memh;
+  }
+}
+#endif
+
+// Finalizes p2p entry from UCX callback or right after posting if operation
+// completed immediately, request is null in the latter case.
+void p2p_complete(
+    torch_ucx_p2p_req_t* req,
+    void* request,
+    ucs_status_t status,
+    const ucp_tag_recv_info_t* info) {
+  std::shared_ptr<ProcessGroupUCC::ProgressEntry> entry = std::move(req->entry);
+  if (info) {
+    entry->source_rank_ = (int)((info->sender_tag & TORCH_UCX_RANK_MASK) >>
+                                TORCH_UCX_RANK_BITS_OFFSET);
+  }
+  delete req;
+  if (request) {
+    entry->comm_->free_request(static_cast<ucc_coll_req_h>(request));
+  }
+  std::exception_ptr eptr;
+  if (status != UCS_OK) {
+    eptr = std::make_exception_ptr(std::runtime_error(c10::str(
+        "failed to complete p2p operation: ", ucs_status_string(status))));
+  }
+  // runs inside ucp_worker_progress, the future is completed by the progress
+  // thread or enqueue_p2p once UCX is not on the stack
+  entry->finalize(eptr, false);
+}
+
+// identifies this process in team cache keys
+uint64_t process_uid() {
+  static const uint64_t uid = []() {
+    std::random_device rd;
+    return ((uint64_t)rd() << 32) ^ (uint64_t)rd() ^ (uint64_t)getpid();
+  }();
+  return uid;
+}
+
+// 64 bit FNV-1a, team cache keys are compared across ranks by their hash
+uint64_t team_key_hash(const std::string& key) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    h = (h ^ c) * 1099511628211ULL;
+  }
+  // 0 marks an unused slot of torch_ucc_team_probe_t
+  return h ? h : 1;
+}
+
+// cached teams a rank announces when a group is created
+constexpr int kTeamCacheProbe = 8;
+
+// Exchanged once per group with TORCH_UCC_TEAM_CACHE: process id of the
+// rank and hashes of cached teams it could reuse for the group.
+struct torch_ucc_team_probe_t {
+  uint64_t uid;
+  uint64_t cached[kTeamCacheProbe];
 };
 
+// operations issued by this thread between groupStart and groupEnd
+using torch_ucc_group_entry_t =
+    std::pair<CommPG*, std::shared_ptr<ProcessGroupUCC::ProgressEntry>>;
+struct torch_ucc_group_t {
+  int depth = 0;
+  std::vector<torch_ucc_group_entry_t> entries;
+  std::vector<c10::intrusive_ptr<ProcessGroupUCC::WorkUCC>> works;
+};
+thread_local torch_ucc_group_t torch_ucc_group;
+
+// Hands deferred operations to their progress threads, one batch per
+// communicator since a group may span process groups.
+void torch_ucc_group_submit(
+    std::vector<torch_ucc_group_entry_t>& group_entries) {
+  std::vector<std::shared_ptr<ProcessGroupUCC::ProgressEntry>> batch;
+  while (!group_entries.empty()) {
+    CommPG* comm = group_entries.front().first;
+    batch.clear();
+    auto it = std::stable_partition(
+        group_entries.begin(),
+        group_entries.end(),
+        [comm](const torch_ucc_group_entry_t& e) { return e.first == comm; });
+    for (auto e = group_entries.begin(); e != it; ++e) {
+      batch.push_back(std::move(e->second));
+    }
+    group_entries.erase(group_entries.begin(), it);
+    comm->submit_batch(batch, true);
+  }
+}
+
+// Flushes the group of this thread if an operation throws inside it.
+// Already posted operations still go to progress threads, they are counted
+// as outstanding and would otherwise be left for the next group or block
+// communicator teardown forever. Depth is kept so that groupEnd issued by
+// error handling still pairs with groupStart.
+struct torch_ucc_group_error_guard {
+  const int exceptions = std::uncaught_exceptions();
+  ~torch_ucc_group_error_guard() {
+    if (torch_ucc_group.depth == 0 ||
+        std::uncaught_exceptions() <= exceptions) {
+      return;
+    }
+    auto group_entries = std::move(torch_ucc_group.entries);
+    torch_ucc_group.entries.clear();
+    torch_ucc_group.works.clear();
+    torch_ucc_group_submit(group_entries);
+  }
+};
+
+// error feedback bucket of the next compressed reduction of this thread, -1
+// if none was set
+thread_local int64_t torch_ucc_compression_bucket = -1;
+
 } // namespace
 
 void read_confg() {
@@ -150,6 +447,35 @@ void read_confg() {
   torch_ucc_config.use_allgatherv = false;
   torch_ucc_config.enable_health_check = false;
   torch_ucc_config.enable_comms_logger = false;
+  torch_ucc_config.progress_spin_usec = -1;
+  torch_ucc_config.progress_cpu = -1;
+  torch_ucc_config.progress_queue_size = 1024;
+  torch_ucc_config.persistent_coll = false;
+  torch_ucc_config.persistent_cache_size = 64;
+  torch_ucc_config.chunk_size = 0;
+  torch_ucc_config.fast_exit = false;
+  torch_ucc_config.async_init = false;
+  torch_ucc_config.team_cache = false;
+  torch_ucc_config.wait_mode = TORCH_UCC_WAIT_SPIN;
+  torch_ucc_config.wait_spin_usec = 50;
+  torch_ucc_config.memh_cache_size = 0;
+  torch_ucc_config.memh_cache_min_size = 65536;
+  torch_ucc_config.eager_threshold = 0;
+  torch_ucc_config.eager_spin = 100;
+  torch_ucc_config.cpu_helpers = 0;
+  torch_ucc_config.cpu_shard_size = 16777216;
+  torch_ucc_config.enable_metrics = false;
+  torch_ucc_config.compression = at::ScalarType::Undefined;
+  torch_ucc_config.compression_error_feedback = false;
+  torch_ucc_config.hier_allreduce_threshold = 0;
+  torch_ucc_config.hier_local_size = 0;
+  torch_ucc_config.tune = false;
+  torch_ucc_config.tune_file = "";
+  torch_ucc_config.tune_max_size = 67108864;
+  torch_ucc_config.alltoall_splits_cache = 16;
+  torch_ucc_config.memory_saving = false;
+  torch_ucc_config.buffer_pool_size = 268435456;
+  torch_ucc_config.compression_min_size = 65536;
 
   // read all torch_ucc env. variables and update the map
   char* env;
@@ -165,6 +491,8 @@ void read_confg() {
       std::stoi(torch_ucc_envs_map.at("TORCH_UCC_ALLGATHER_BASE_BLOCKING_WAIT"));
   torch_ucc_config.blocking_wait[(std::uint8_t)OpType::ALLREDUCE] =
       std::stoi(torch_ucc_envs_map.at("TORCH_UCC_ALLREDUCE_BLOCKING_WAIT"));
+  torch_ucc_config.blocking_wait[(std::uint8_t)OpType::ALLREDUCE_COALESCED] =
+      torch_ucc_config.blocking_wait[(std::uint8_t)OpType::ALLREDUCE];
   torch_ucc_config.blocking_wait[(std::uint8_t)OpType::ALLTOALL_BASE] =
       std::stoi(torch_ucc_envs_map.at("TORCH_UCC_ALLTOALL_BLOCKING_WAIT"));
   torch_ucc_config.blocking_wait[(std::uint8_t)OpType::BROADCAST] =
@@ -191,6 +519,74 @@ void read_confg() {
       std::stoi(torch_ucc_envs_map.at("TORCH_UCC_ENABLE_HEALTH_CHECK"));
   torch_ucc_config.enable_comms_logger =
       std::stoi(torch_ucc_envs_map.at("TORCH_UCC_ENABLE_COMMS_LOGGER"));
+  torch_ucc_config.progress_spin_usec =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_PROGRESS_SPIN_USEC"));
+  torch_ucc_config.progress_cpu =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_PROGRESS_CPU"));
+  torch_ucc_config.progress_queue_size =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_PROGRESS_QUEUE_SIZE"));
+  torch_ucc_config.persistent_coll =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_PERSISTENT_COLL"));
+  torch_ucc_config.persistent_cache_size =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_PERSISTENT_CACHE_SIZE"));
+  torch_ucc_config.chunk_size =
+      std::stoll(torch_ucc_envs_map.at("TORCH_UCC_CHUNK_SIZE"));
+  torch_ucc_config.fast_exit =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_FAST_EXIT"));
+  torch_ucc_config.async_init =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_ASYNC_INIT"));
+  torch_ucc_config.team_cache =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_TEAM_CACHE"));
+  try {
+    torch_ucc_config.wait_mode =
+        torch_ucc_wait_mode_map.at(torch_ucc_envs_map.at("TORCH_UCC_WAIT_MODE"));
+  } catch (const std::out_of_range&) {
+    throw std::invalid_argument(c10::str(
+        "TORCH_UCC_WAIT_MODE has to be one of spin, yield or park, got ",
+        torch_ucc_envs_map.at("TORCH_UCC_WAIT_MODE")));
+  }
+  torch_ucc_config.wait_spin_usec =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_WAIT_SPIN_USEC"));
+  torch_ucc_config.memh_cache_size =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_MEMH_CACHE"));
+  torch_ucc_config.memh_cache_min_size =
+      std::stoll(torch_ucc_envs_map.at("TORCH_UCC_MEMH_CACHE_MIN_SIZE"));
+  torch_ucc_config.eager_threshold =
+      std::stoll(torch_ucc_envs_map.at("TORCH_UCC_EAGER_THRESHOLD"));
+  torch_ucc_config.eager_spin =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_EAGER_SPIN"));
+  torch_ucc_config.cpu_helpers =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_CPU_HELPERS"));
+  torch_ucc_config.cpu_shard_size =
+      std::stoll(torch_ucc_envs_map.at("TORCH_UCC_CPU_SHARD_SIZE"));
+  torch_ucc_config.enable_metrics =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_ENABLE_METRICS"));
+  try {
+    torch_ucc_config.compression = torch_ucc_compression_map.at(
+        torch_ucc_envs_map.at("TORCH_UCC_COMPRESSION"));
+  } catch (const std::out_of_range&) {
+    throw std::invalid_argument(c10::str(
+        "TORCH_UCC_COMPRESSION has to be one of none, fp16 or bf16, got ",
+        torch_ucc_envs_map.at("TORCH_UCC_COMPRESSION")));
+  }
+  torch_ucc_config.compression_error_feedback = std::stoi(
+      torch_ucc_envs_map.at("TORCH_UCC_COMPRESSION_ERROR_FEEDBACK"));
+  torch_ucc_config.hier_allreduce_threshold =
+      std::stoll(torch_ucc_envs_map.at("TORCH_UCC_HIER_ALLREDUCE_THRESHOLD"));
+  torch_ucc_config.hier_local_size =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_HIER_LOCAL_SIZE"));
+  torch_ucc_config.tune = std::stoi(torch_ucc_envs_map.at("TORCH_UCC_TUNE"));
+  torch_ucc_config.tune_file = torch_ucc_envs_map.at("TORCH_UCC_TUNE_FILE");
+  torch_ucc_config.tune_max_size =
+      std::stoll(torch_ucc_envs_map.at("TORCH_UCC_TUNE_MAX_SIZE"));
+  torch_ucc_config.alltoall_splits_cache =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_ALLTOALL_SPLITS_CACHE"));
+  torch_ucc_config.memory_saving =
+      std::stoi(torch_ucc_envs_map.at("TORCH_UCC_MEMORY_SAVING"));
+  torch_ucc_config.buffer_pool_size =
+      std::stoll(torch_ucc_envs_map.at("TORCH_UCC_BUFFER_POOL_SIZE"));
+  torch_ucc_config.compression_min_size =
+      std::stoll(torch_ucc_envs_map.at("TORCH_UCC_COMPRESSION_MIN_SIZE"));
 }
 
 void check_device(c10::Device dev1, c10::Device dev2) {
@@ -213,6 +609,300 @@ void check_tensor(const std::vector<at::Tensor>& tensors) {
   // TODO: check cuda case
 }
 
+// Buffer split into chunks by TORCH_UCC_CHUNK_SIZE, destination for
+// allreduce and source for broadcast.
+ucc_coll_buffer_info_t& coll_chunked_info(ucc_coll_args_t& coll) {
+  return coll.coll_type == UCC_COLL_TYPE_BCAST ? coll.src.info : coll.dst.info;
+}
+
+size_t tensors_nbytes(const std::vector<at::Tensor>& tensors) {
+  size_t nbytes = 0;
+  for (const auto& t : tensors) {
+    // sparse tensors send their indices and values
+    nbytes += t.is_sparse() ? t._indices().nbytes() + t._values().nbytes()
+                            : t.nbytes();
+  }
+  return nbytes;
+}
+
+// Number of chunks CUDA collective is split into, only element-wise
+// collectives are split.
+size_t num_coll_chunks(
+    ucc_coll_args_t& coll,
+    const std::vector<at::Tensor>& tensors) {
+  if (torch_ucc_config.chunk_size <= 0 || tensors.empty() ||
+      (coll.coll_type != UCC_COLL_TYPE_ALLREDUCE &&
+       coll.coll_type != UCC_COLL_TYPE_BCAST)) {
+    return 1;
+  }
+#ifdef USE_ACTIVE_SETS
+  if (coll.mask & UCC_COLL_ARGS_FIELD_ACTIVE_SET) {
+    return 1;
+  }
+#endif
+  // whole elements per chunk, chunk size need not be a multiple of them
+  const uint64_t count = coll_chunked_info(coll).count;
+  const uint64_t chunk_elems = std::max<uint64_t>(
+      1, torch_ucc_config.chunk_size / tensors[0].element_size());
+  return std::max<uint64_t>(1, (count + chunk_elems - 1) / chunk_elems);
+}
+
+// Elements per piece of a collective of count elements split into at most
+// pieces parts, pieces is lowered to the number of non-empty parts.
+uint64_t split_piece_count(uint64_t count, size_t& pieces) {
+  const uint64_t piece_count =
+      std::max<uint64_t>(1, (count + pieces - 1) / pieces);
+  pieces = std::max<uint64_t>(1, (count + piece_count - 1) / piece_count);
+  return piece_count;
+}
+
+// Number of shards CPU collective is split into across CPU helpers, same
+// collectives as for CUDA chunking qualify.
+size_t num_cpu_shards(
+    ucc_coll_args_t& coll,
+    const std::vector<at::Tensor>& tensors) {
+  if (torch_ucc_config.cpu_helpers <= 0 ||
+      torch_ucc_config.cpu_shard_size <= 0 || tensors.empty() ||
+      (coll.coll_type != UCC_COLL_TYPE_ALLREDUCE &&
+       coll.coll_type != UCC_COLL_TYPE_BCAST)) {
+    return 1;
+  }
+#ifdef USE_ACTIVE_SETS
+  if (coll.mask & UCC_COLL_ARGS_FIELD_ACTIVE_SET) {
+    return 1;
+  }
+#endif
+  const uint64_t nbytes =
+      coll_chunked_info(coll).count * tensors[0].element_size();
+  const uint64_t shards = nbytes / torch_ucc_config.cpu_shard_size;
+  return std::max<uint64_t>(
+      1, std::min<uint64_t>(shards, torch_ucc_config.cpu_helpers + 1));
+}
+
+// Arguments of the piece [offset, offset + count) of a chunked collective.
+ucc_coll_args_t coll_chunk_args(
+    const ucc_coll_args_t& coll,
+    uint64_t offset,
+    uint64_t count,
+    size_t element_size) {
+  ucc_coll_args_t chunk_coll = coll;
+  auto& chunk_info = coll_chunked_info(chunk_coll);
+  chunk_info.buffer =
+      static_cast<char*>(chunk_info.buffer) + offset * element_size;
+  chunk_info.count = count;
+  if (coll.coll_type == UCC_COLL_TYPE_ALLREDUCE) {
+    if (!(coll.flags & UCC_COLL_ARGS_FLAG_IN_PLACE)) {
+      chunk_coll.src.info.buffer =
+          static_cast<char*>(coll.src.info.buffer) + offset * element_size;
+    }
+    chunk_coll.src.info.count = count;
+  }
+  return chunk_coll;
+}
+
+// True if tensors are contiguous chunks shaped like `like` and laid out back
+// to back in one storage, so they can be passed to UCC as a single buffer.
+bool is_flat_view(
+    const std::vector<at::Tensor>& tensors,
+    const at::Tensor& like) {
+  const size_t nbytes = like.numel() * like.element_size();
+  if (tensors.empty() || nbytes == 0) {
+    return false;
+  }
+  const char* base = static_cast<const char*>(tensors[0].data_ptr());
+  for (size_t i = 0; i < tensors.size(); i++) {
+    const auto& t = tensors[i];
+    if (!t.is_contiguous() || t.is_sparse() ||
+        t.scalar_type() != like.scalar_type() ||
+        t.device() != tensors[0].device() || t.numel() != like.numel() ||
+        !t.storage().is_alias_of(tensors[0].storage()) ||
+        static_cast<const char*>(t.data_ptr()) != base + i * nbytes) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef USE_CUDA
+// error feedback residuals kept per process group, more distinct buckets
+// than that means buckets were rebuilt and old residuals are dropped
+constexpr size_t kMaxCompressionResiduals = 256;
+
+// True if reduction of tensor is sent in TORCH_UCC_COMPRESSION type, only
+// float32 CUDA sums and averages of at least TORCH_UCC_COMPRESSION_MIN_SIZE
+// bytes are compressed. Small reductions such as losses and counters stay
+// exact.
+bool use_compression(const at::Tensor& tensor, const ReduceOp& op) {
+  if (torch_ucc_config.compression == at::ScalarType::Undefined ||
+      !tensor.device().is_cuda() || tensor.scalar_type() != at::kFloat ||
+      (int64_t)tensor.nbytes() < torch_ucc_config.compression_min_size) {
+    return false;
+  }
+#if TORCH_VERSION_MAJOR > 1 || \
+    (TORCH_VERSION_MAJOR == 1 && TORCH_VERSION_MINOR >= 11)
+  if (op == ReduceOp::AVG) {
+    return true;
+  }
+#endif
+  return op == ReduceOp::SUM;
+}
+
+// Casts src into wire. With error feedback residual holds the rounding error
+// of the previous call on the same buffer, it is added back before the cast
+// and replaced by the new error.
+void compress_tensor(
+    const at::Tensor& src,
+    const at::Tensor& wire,
+    const at::Tensor& residual) {
+  if (!residual.defined()) {
+    wire.copy_(src);
+    return;
+  }
+  residual.add_(src);
+  wire.copy_(residual);
+  residual.sub_(wire);
+}
+#endif
+
+// Serializes everything that identifies a collective into key, returns false
+// for collectives that can't be cached.
+bool persistent_coll_key(
+    const ucc_coll_args_t& coll,
+    int team_size,
+    std::string& key) {
+  auto append = [&key](const void* ptr, size_t len) {
+    key.append(reinterpret_cast<const char*>(ptr), len);
+  };
+  auto append_info = [&append](const ucc_coll_buffer_info_t& info) {
+    append(&info.buffer, sizeof(info.buffer));
+    append(&info.count, sizeof(info.count));
+    append(&info.datatype, sizeof(info.datatype));
+    append(&info.mem_type, sizeof(info.mem_type));
+  };
+  auto append_info_v = [&append, team_size](
+                           const ucc_coll_buffer_info_v_t& info) {
+    append(&info.buffer, sizeof(info.buffer));
+    append(&info.datatype, sizeof(info.datatype));
+    append(&info.mem_type, sizeof(info.mem_type));
+    append(info.counts, sizeof(uint64_t) * team_size);
+    append(info.displacements, sizeof(uint64_t) * team_size);
+  };
+  const uint64_t v_flags =
+      UCC_COLL_ARGS_FLAG_COUNT_64BIT | UCC_COLL_ARGS_FLAG_DISPLACEMENTS_64BIT;
+
+#ifdef USE_ACTIVE_SETS
+  if (coll.mask & UCC_COLL_ARGS_FIELD_ACTIVE_SET) {
+    return false;
+  }
+#endif
+  append(&coll.coll_type, sizeof(coll.coll_type));
+  append(&coll.mask, sizeof(coll.mask));
+  append(&coll.flags, sizeof(coll.flags));
+  switch (coll.coll_type) {
+    case UCC_COLL_TYPE_BARRIER:
+      break;
+    case UCC_COLL_TYPE_BCAST:
+      append_info(coll.src.info);
+      append(&coll.root, sizeof(coll.root));
+      break;
+    case UCC_COLL_TYPE_REDUCE:
+      append(&coll.root, sizeof(coll.root));
+      // fall through
+    case UCC_COLL_TYPE_ALLREDUCE:
+    case UCC_COLL_TYPE_REDUCE_SCATTER:
+      append(&coll.op, sizeof(coll.op));
+      // fall through
+    case UCC_COLL_TYPE_ALLGATHER:
+    case UCC_COLL_TYPE_ALLTOALL:
+      append_info(coll.src.info);
+      append_info(coll.dst.info);
+      break;
+    case UCC_COLL_TYPE_ALLGATHERV:
+      if ((coll.flags & v_flags) != v_flags) {
+        return false;
+      }
+      append_info(coll.src.info);
+      append_info_v(coll.dst.info_v);
+      break;
+    case UCC_COLL_TYPE_ALLTOALLV:
+      if ((coll.flags & v_flags) != v_flags) {
+        return false;
+      }
+      append_info_v(coll.src.info_v);
+      append_info_v(coll.dst.info_v);
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+#ifdef TORCH_UCC_SEGMENT_EVENTS
+// bytes per element of the datatypes posted by the process group
+size_t ucc_dt_bytes(ucc_datatype_t dt) {
+  switch (dt) {
+    case UCC_DT_FLOAT16:
+    case UCC_DT_BFLOAT16:
+      return 2;
+    case UCC_DT_FLOAT32:
+    case UCC_DT_INT32:
+      return 4;
+    case UCC_DT_FLOAT64:
+    case UCC_DT_INT64:
+      return 8;
+    default:
+      return 1;
+  }
+}
+
+// Address ranges of CUDA buffers of a collective accepted by
+// persistent_coll_key.
+std::vector<std::pair<uintptr_t, size_t>> persistent_coll_buffers(
+    const ucc_coll_args_t& coll,
+    int team_size) {
+  std::vector<std::pair<uintptr_t, size_t>> ranges;
+  auto add_info = [&ranges](const ucc_coll_buffer_info_t& info) {
+    if (info.mem_type == UCC_MEMORY_TYPE_CUDA) {
+      ranges.emplace_back(
+          (uintptr_t)info.buffer, info.count * ucc_dt_bytes(info.datatype));
+    }
+  };
+  auto add_info_v = [&ranges, team_size](const ucc_coll_buffer_info_v_t& info) {
+    if (info.mem_type != UCC_MEMORY_TYPE_CUDA) {
+      return;
+    }
+    auto counts = reinterpret_cast<const uint64_t*>(info.counts);
+    auto displs = reinterpret_cast<const uint64_t*>(info.displacements);
+    uint64_t extent = 0;
+    for (int r = 0; r < team_size; r++) {
+      extent = std::max(extent, displs[r] + counts[r]);
+    }
+    ranges.emplace_back(
+        (uintptr_t)info.buffer, extent * ucc_dt_bytes(info.datatype));
+  };
+  switch (coll.coll_type) {
+    case UCC_COLL_TYPE_BARRIER:
+      break;
+    case UCC_COLL_TYPE_BCAST:
+      add_info(coll.src.info);
+      break;
+    case UCC_COLL_TYPE_ALLGATHERV:
+      add_info(coll.src.info);
+      add_info_v(coll.dst.info_v);
+      break;
+    case UCC_COLL_TYPE_ALLTOALLV:
+      add_info_v(coll.src.info_v);
+      add_info_v(coll.dst.info_v);
+      break;
+    default:
+      add_info(coll.src.info);
+      add_info(coll.dst.info);
+      break;
+  }
+  return ranges;
+}
+#endif
+
 ProcessGroupUCC::WorkUCC::~WorkUCC() {
 #ifdef USE_CUDA
   if (fence && ep) {
@@ -223,7 +913,17 @@ ProcessGroupUCC::WorkUCC::~WorkUCC() {
 }
 
 void ProcessGroupUCC::WorkUCC::setException() {
-  if (exception() || !entry_) {
+  if (exception()) {
+    return;
+  }
+  for (auto& chunk : chunks_) {
+    chunk->setException();
+    if (chunk->exception()) {
+      exception_ = chunk->exception();
+      return;
+    }
+  }
+  if (!entry_) {
     return;
   }
   exception_ = entry_->eptr_;
@@ -237,21 +937,100 @@ void ProcessGroupUCC::WorkUCC::setAndThrowException() {
 }
 
 bool ProcessGroupUCC::WorkUCC::isCompleted() {
+  if (!chunks_.empty()) {
+    setException();
+    return exception() ||
+        std::all_of(
+               chunks_.begin(),
+               chunks_.end(),
+               [](const c10::intrusive_ptr<WorkUCC>& chunk) {
+                 return chunk->isCompleted();
+               });
+  }
   if (!entry_) {
     return true;
   }
   setException();
-  return exception() || entry_->status_ <= 0;
+  if (!entry_->completed()) {
+    return exception() != nullptr;
+  }
+  // future of p2p entries is left to the progress thread by UCX callbacks,
+  // a completed work always has a completed future
+  entry_->completeFuture();
+  return true;
 }
 
 bool ProcessGroupUCC::WorkUCC::isSuccess() const {
+  if (!chunks_.empty()) {
+    return !exception() &&
+        std::all_of(
+               chunks_.begin(),
+               chunks_.end(),
+               [](const c10::intrusive_ptr<WorkUCC>& chunk) {
+                 return chunk->isSuccess();
+               });
+  }
   if (!entry_) {
     return true;
   }
   return !exception() && entry_->status_ == 0;
 }
 
-bool ProcessGroupUCC::WorkUCC::wait(std::chrono::milliseconds /* unused */) {
+#ifdef USE_CUDA
+void ProcessGroupUCC::WorkUCC::blockChunk(size_t i) {
+  TORCH_CHECK(i < chunks_.size(), "chunk index out of range");
+  setAndThrowException();
+  chunks_[i]->fence->block(at::cuda::getCurrentCUDAStream());
+}
+#endif
+
+bool ProcessGroupUCC::WorkUCC::waitCompleted(
+    const std::chrono::steady_clock::time_point* deadline) {
+  if (!chunks_.empty()) {
+    for (auto& chunk : chunks_) {
+      if (!chunk->waitCompleted(deadline)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (!entry_) {
+    return true;
+  }
+  switch (torch_ucc_config.wait_mode) {
+    case TORCH_UCC_WAIT_PARK: {
+      auto spin_end = std::chrono::steady_clock::now() +
+          std::chrono::microseconds(torch_ucc_config.wait_spin_usec);
+      while (!isCompleted()) {
+        if (std::chrono::steady_clock::now() >= spin_end) {
+          if (!entry_->wait(deadline)) {
+            return false;
+          }
+          entry_->completeFuture();
+          return true;
+        }
+      }
+      return true;
+    }
+    case TORCH_UCC_WAIT_YIELD:
+      while (!isCompleted()) {
+        if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+          return false;
+        }
+        std::this_thread::yield();
+      }
+      return true;
+    default:
+      while (!isCompleted()) {
+        if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+          return false;
+        }
+      }
+      return true;
+  }
+}
+
+bool ProcessGroupUCC::WorkUCC::wait(std::chrono::milliseconds timeout) {
   if (torch_ucc_config.enable_comms_logger && logger_) {
     logger_->trace_generator->recordComms(
         "wait",
@@ -259,16 +1038,40 @@ bool ProcessGroupUCC::WorkUCC::wait(std::chrono::milliseconds /* unused */) {
         rank_);
   }
 #ifdef USE_CUDA
-  if (fence && !torch_ucc_config.blocking_wait[(int)opType_]) {
+  if (capture_fence) {
+    // host side of a captured collective has nothing to wait for, replays
+    // are ordered by graph launches. Only the capture that recorded the
+    // collective can depend on it, waiting on the event from another one
+    // would invalidate it.
+    auto current = at::cuda::getCurrentCUDAStream();
+    cudaStreamCaptureStatus status;
+    unsigned long long id = 0;
+    C10_CUDA_CHECK(cudaStreamGetCaptureInfo(current.stream(), &status, &id));
+    if (status == cudaStreamCaptureStatusActive && id == capture_id) {
+      capture_fence->block(current);
+    }
+    return true;
+  }
+  if (fence && !host_completion &&
+      !torch_ucc_config.blocking_wait[(int)opType_]) {
     // block user stream
     setAndThrowException();
     fence->block(at::cuda::getCurrentCUDAStream());
     return true;
   }
 #endif
-  // wait for complete
-  while (!isCompleted())
-    ;
+  // wait for complete, c10d and Python pass kNoTimeout when no timeout is
+  // given, such waits use the process group timeout
+  if (timeout == kNoTimeout || timeout == kUnsetTimeout) {
+    timeout = default_timeout_;
+  }
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  if (!waitCompleted(timeout <= kNoTimeout ? nullptr : &deadline)) {
+    throw std::runtime_error(c10::str(
+        "ProcessGroupUCC work wait timed out after ",
+        timeout.count(),
+        " ms"));
+  }
   setAndThrowException();
   // manually call profiling end callbacks if they are set,
   // since progress thread does not own WorkUCC
@@ -279,6 +1082,13 @@ bool ProcessGroupUCC::WorkUCC::wait(std::chrono::milliseconds /* unused */) {
   return true;
 }
 
+int ProcessGroupUCC::WorkUCC::sourceRank() const {
+  TORCH_CHECK(
+      entry_ && entry_->completed() && entry_->source_rank_ >= 0,
+      "sourceRank() may only be called on a completed receive");
+  return entry_->source_rank_;
+}
+
 c10::intrusive_ptr<c10::ivalue::Future> ProcessGroupUCC::WorkUCC::getFuture() {
   return future_;
 }
@@ -287,19 +1097,114 @@ std::vector<at::Tensor> ProcessGroupUCC::WorkUCC::result() {
   return *outputs_;
 }
 
-void ProcessGroupUCC::ProgressEntry::finalize(std::exception_ptr eptr) {
+bool ProcessGroupUCC::GroupWorkUCC::isCompleted() {
+  for (auto& work : works_) {
+    if (!work->isCompleted()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ProcessGroupUCC::GroupWorkUCC::isSuccess() const {
+  for (auto& work : works_) {
+    if (!work->isSuccess()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ProcessGroupUCC::GroupWorkUCC::wait(std::chrono::milliseconds timeout) {
+  // timeout covers the whole group
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (auto& work : works_) {
+    if (timeout == kNoTimeout || timeout == kUnsetTimeout) {
+      // every work applies its own process group timeout
+      work->wait(timeout);
+      continue;
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    work->wait(std::max(left, std::chrono::milliseconds(0)));
+  }
+  return true;
+}
+
+void ProcessGroupUCC::ProgressEntry::completeFuture() {
+  if (!future_deferred_.exchange(false)) {
+    if (future_ && !future_->completed()) {
+      // another thread is still marking it
+      future_->wait();
+    }
+    return;
+  }
+  if (eptr_) {
+    future_->setError(eptr_);
+  } else {
+    future_->markCompleted(c10::IValue(std::move(future_result_)));
+  }
+}
+
+bool ProcessGroupUCC::ProgressEntry::wait(
+    const std::chrono::steady_clock::time_point* deadline) {
+  if (completed_) {
+    return true;
+  }
+  waiters_++;
+  std::unique_lock<std::mutex> lock(completion_mutex_);
+  bool completed = true;
+  if (deadline) {
+    completed = completion_cv_.wait_until(
+        lock, *deadline, [this]() { return completed_.load(); });
+  } else {
+    completion_cv_.wait(lock, [this]() { return completed_.load(); });
+  }
+  waiters_--;
+  return completed;
+}
+
+void ProcessGroupUCC::ProgressEntry::finalize(
+    std::exception_ptr eptr,
+    bool complete_future) {
+  if (finalized_.exchange(true)) {
+    return;
+  }
+  const int64_t finalize_ns = metrics_ ? torch_ucc_now_ns() : 0;
   ucc_status_t status = UCC_OK;
 
   if (request_ != nullptr) {
     status = request_->status;
-    comm_->free_request(request_);
+    if (persistent_) {
+      // keep the request, it is reposted by the next identical collective
+      persistent_->inflight = false;
+      persistent_ = nullptr;
+    } else {
+      comm_->free_request(request_);
+    }
+  }
+  if (data) {
+    data->complete(!eptr && status == UCC_OK);
   }
   if (eptr) {
     eptr_ = eptr;
   } else {
     status_ = status;
   }
-  if (future_) {
+  if (metrics_) {
+    // recorded before the work completes so waiters find it in metrics
+    metrics_->record(
+        sample_,
+        progress_ns_.load(std::memory_order_relaxed),
+        finalize_ns,
+        torch_ucc_now_ns());
+  }
+  if (future_ && !complete_future) {
+    if (data) {
+      future_result_ = data->dst;
+    }
+    future_deferred_ = true;
+  } else if (future_) {
     if (eptr) {
       future_->setError(eptr);
     } else {
@@ -307,36 +1212,83 @@ void ProcessGroupUCC::ProgressEntry::finalize(std::exception_ptr eptr) {
           c10::IValue(data ? data->dst : std::vector<at::Tensor>()));
     }
   }
+  if (torch_ucc_config.memory_saving && data && !data->keep_buffers) {
+    // request is done, drop tensors and staging buffers now rather than
+    // with the work, future and result keep their own references
+    data.reset();
+  }
+  // pairs with waiters_ increment in wait, either the waiter sees completed_
+  // or the notification below
+  completed_ = true;
+  if (waiters_) {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    completion_cv_.notify_all();
+  }
 }
 
 CommPG::CommPG(
     const c10::intrusive_ptr<ProcessGroupUCCLogger>& logger_,
     std::shared_ptr<torch_ucc_oob_coll_info_t> oob_,
     c10::Device dev,
-    bool is_health_check)
+    bool is_health_check,
+    int helper_index)
     : logger(logger_),
       oob(oob_),
-      ucx_comm(oob->size, logger),
+      ucx_comm(oob->size, logger, torch_ucc_config.progress_spin_usec >= 0),
       ucc_comm(oob, logger),
+      progress_queue(torch_ucc_config.progress_queue_size),
       finalize_phase(is_health_check ? TORCH_UCC_HEALTH_CHECK : TORCH_UCC_FINALIZE),
       cuda_device_index(TORCH_UCC_DEVICE_NOT_SET) {
   if (dev.is_cuda()) {
     cuda_device_index = dev.index();
   }
   stop_progress_loop = false;
-  collective_inprogress = false;
+  outstanding_requests = 0;
+  drain_waiters = 0;
+  progress_thread_state = TORCH_UCC_PROGRESS_RUNNING;
+#ifdef TORCH_UCX_MEMH_CACHE
+  if (torch_ucc_config.memh_cache_size > 0) {
+    memh_cache_attach(this);
+  }
+#endif
   progress_thread = std::thread(&CommPG::progress_loop, this);
   pthread_setname_np(progress_thread.native_handle(), "ucc-progress");
+  if (torch_ucc_config.progress_cpu >= 0) {
+    const int cpu = torch_ucc_config.progress_cpu + helper_index;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    int ret = pthread_setaffinity_np(
+        progress_thread.native_handle(), sizeof(cpu_set_t), &cpuset);
+    if (ret != 0) {
+      TORCH_UCC_LOG_ERROR(
+          TORCH_UCC_INIT,
+          c10::str(
+              "failed to pin progress thread to CPU ",
+              cpu,
+              ": ",
+              strerror(ret)));
+    }
+  }
 }
 
 CommPG::~CommPG() {
-  std::unique_lock<std::mutex> lock(mutex);
-  queue_consume_cv.wait(
-      lock, [&] { return progress_queue.empty() && !collective_inprogress; });
-  stop_progress_loop = true;
-  lock.unlock();
+  wait_for_drain();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop_progress_loop = true;
+  }
   queue_produce_cv.notify_all();
+  if (torch_ucc_config.progress_spin_usec >= 0) {
+    ucp_worker_signal(ucx_comm.worker);
+  }
   progress_thread.join();
+#ifdef TORCH_UCX_MEMH_CACHE
+  memh_cache_detach(this);
+  // registrations belong to UCX context destroyed with ucx_comm
+  memh_cache.clear();
+  memh_lru.clear();
+#endif
 }
 
 std::shared_ptr<CommPG> CommPG::get_comm(
@@ -386,15 +1338,10 @@ std::shared_ptr<CommPG> CommPG::get_comm(
           logger, oob, dev, is_health_check);
       comm = shared_comm;
     } else {
-      if (dev.is_cuda() && !is_health_check) {
-        if ((shared_comm->cuda_device_index != TORCH_UCC_DEVICE_NOT_SET) &&
-            (shared_comm->cuda_device_index != dev.index())) {
-          TORCH_UCC_LOG_ERROR(
-              is_health_check ? TORCH_UCC_HEALTH_CHECK : TORCH_UCC_INIT,
-              "ucc communicator was initialized with different cuda device,"
-              "multi device is not supported");
-          throw std::runtime_error(ucc_status_string(UCC_ERR_NOT_SUPPORTED));
-        }
+      // groups on other devices share the communicator too, progress thread
+      // stays on the first device
+      if (dev.is_cuda() && !is_health_check &&
+          shared_comm->cuda_device_index == TORCH_UCC_DEVICE_NOT_SET) {
         shared_comm->cuda_device_index = dev.index();
       }
     }
@@ -405,124 +1352,321 @@ std::shared_ptr<CommPG> CommPG::get_comm(
 }
 
 void CommPG::ucx_connect_eps(
-    std::vector<ucp_ep_h>& eps,
-    std::shared_ptr<torch_ucc_oob_coll_info_t> oob) {
+    torch_ucx_eps_t& eps,
+    std::shared_ptr<torch_ucc_oob_coll_info_t> oob,
+    bool lazy) {
   ucp_address_t* local_addr;
   size_t local_addr_len;
-  std::vector<uint8_t> peer_addr;
 
   TORCH_UCX_CHECK(
       ucp_worker_get_address(ucx_comm.worker, &local_addr, &local_addr_len),
       "failed to get worker address");
-
-  std::vector<uint8_t> val = std::vector<uint8_t>(
+  std::vector<uint8_t> local(
       reinterpret_cast<uint8_t*>(local_addr),
       reinterpret_cast<uint8_t*>(local_addr) + local_addr_len);
-  oob->store->set(oob->getKey("wa" + std::to_string(oob->rank)), val);
   ucp_worker_release_address(ucx_comm.worker, local_addr);
-  eps.resize(oob->size);
-  for (int i = 0; i < oob->size; i++) {
-    peer_addr = oob->store->get(oob->getKey("wa" + std::to_string(i)));
+
+  // addresses differ in length, agree on the longest one first
+  std::vector<uint64_t> lens(oob->size);
+  uint64_t len = local.size();
+  oob_allgather_sync(oob.get(), &len, lens.data(), sizeof(len));
+  eps.addr_len = *std::max_element(lens.begin(), lens.end());
+  local.resize(eps.addr_len);
+  eps.addrs.resize(eps.addr_len * oob->size);
+  oob_allgather_sync(oob.get(), local.data(), eps.addrs.data(), eps.addr_len);
+  eps.eps.assign(oob->size, nullptr);
+  if (!lazy) {
+    for (int i = 0; i < oob->size; i++) {
+      ucx_get_ep(eps, i);
+    }
+  }
+}
+
+ucp_ep_h CommPG::ucx_get_ep(torch_ucx_eps_t& eps, int rank) {
+  std::lock_guard<std::mutex> lock(eps.mutex);
+  if (eps.eps[rank] == nullptr) {
     ucp_ep_params_t ep_params;
     ep_params.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
-    ep_params.address = reinterpret_cast<ucp_address_t*>(peer_addr.data());
+    ep_params.address =
+        reinterpret_cast<ucp_address_t*>(&eps.addrs[eps.addr_len * rank]);
     TORCH_UCX_CHECK(
-        ucp_ep_create(ucx_comm.worker, &ep_params, &(eps[i])),
-        c10::str("failed to create endpoint with rank ", i));
+        ucp_ep_create(ucx_comm.worker, &ep_params, &(eps.eps[rank])),
+        c10::str("failed to create endpoint with rank ", rank));
   }
+  return eps.eps[rank];
 }
 
 void CommPG::ucx_disconnect_eps(
-    std::vector<ucp_ep_h>& eps,
+    torch_ucx_eps_t& eps,
     std::shared_ptr<torch_ucc_oob_coll_info_t> oob) {
-  ucs_status_t st;
-
-  for (ucp_ep_h& ep : eps) {
-    ucs_status_ptr_t close_req = ucp_ep_close_nb(ep, UCP_EP_CLOSE_MODE_FLUSH);
+  // with fast exit peers are not waited for, outstanding sends are dropped
+  const unsigned close_mode = torch_ucc_config.fast_exit
+      ? UCP_EP_CLOSE_MODE_FORCE
+      : UCP_EP_CLOSE_MODE_FLUSH;
+  std::vector<ucs_status_ptr_t> close_reqs;
+  for (ucp_ep_h& ep : eps.eps) {
+    if (ep == nullptr) {
+      continue;
+    }
+    ucs_status_ptr_t close_req = ucp_ep_close_nb(ep, close_mode);
+    ep = nullptr;
     if (UCS_PTR_IS_ERR(close_req)) {
       TORCH_UCC_LOG_ERROR(
           finalize_phase,
           "failed to close endpoint, ignore and continue...");
-      return;
+      continue;
     }
     if (UCS_PTR_IS_PTR(close_req)) {
-      do {
-        ucp_worker_progress(ucx_comm.worker);
-        st = ucp_request_check_status(close_req);
-      } while (st != UCS_OK);
-      ucp_request_free(close_req);
+      close_reqs.push_back(close_req);
+    }
+  }
+  // progress all close requests together
+  while (!close_reqs.empty()) {
+    ucp_worker_progress(ucx_comm.worker);
+    for (auto it = close_reqs.begin(); it != close_reqs.end();) {
+      if (ucp_request_check_status(*it) == UCS_INPROGRESS) {
+        ++it;
+        continue;
+      }
+      ucp_request_free(*it);
+      it = close_reqs.erase(it);
     }
   }
-  if (!eps.size()) {
+  if (!eps.eps.size() || torch_ucc_config.fast_exit) {
     return;
   }
+  // peers may still flush their endpoints to us, keep worker progressing
+  // while blocked on the store
+  std::atomic<bool> closed(false);
+  std::thread progress_thr([this, &closed]() {
+    while (!closed) {
+      if (ucp_worker_progress(ucx_comm.worker) == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
   try {
     auto sz = (size_t)oob->store->add(oob->getKey("epclosed"), 1);
-    while (sz != eps.size()) {
-      ucp_worker_progress(ucx_comm.worker);
-      std::this_thread::sleep_for(std::chrono::milliseconds(kBusyWaitMillis));
-      sz = (size_t)oob->store->add(oob->getKey("epclosed"), 0);
+    if (sz == eps.eps.size()) {
+      std::vector<uint8_t> val = {1};
+      oob->store->set(oob->getKey("epclosed_all"), val);
+    } else {
+      oob->store->wait({oob->getKey("epclosed_all")});
     }
   } catch (std::exception& ex) {
     LOG(ERROR) << "(disconnect_eps) Caught error in Store Operation .. "
                << "[" << ex.what() << "]";
   }
+  closed = true;
+  progress_thr.join();
+}
+
+#ifdef TORCH_UCX_MEMH_CACHE
+std::shared_ptr<torch_ucx_memh_t>
+CommPG::ucx_get_memh(void* ptr, size_t size, ucs_memory_type_t mtype) {
+  if (torch_ucc_config.memh_cache_size <= 0 ||
+      (int64_t)size < torch_ucc_config.memh_cache_min_size ||
+      mtype != UCS_MEMORY_TYPE_CUDA) {
+    return nullptr;
+  }
+  size_t seg_size = 0;
+  void* seg_base;
+  try {
+    seg_base =
+        c10::cuda::CUDACachingAllocator::getBaseAllocation(ptr, &seg_size);
+  } catch (const c10::Error&) {
+    // not allocated by caching allocator
+    return nullptr;
+  }
+  const uintptr_t base = (uintptr_t)seg_base;
+
+  std::lock_guard<std::mutex> lock(memh_mutex);
+  std::vector<std::pair<uintptr_t, size_t>> freed;
+  {
+    std::lock_guard<std::mutex> freed_lock(memh_freed_mutex);
+    freed.swap(memh_freed);
+  }
+  for (const auto& range : freed) {
+    memh_cache_erase(range.first, range.second);
+  }
+  auto it = memh_cache.find(base);
+  if (it != memh_cache.end() && it->second.memh->size == seg_size) {
+    memh_lru.splice(memh_lru.begin(), memh_lru, it->second.lru);
+    return it->second.memh;
+  }
+  // segments overlapping the new one were released, drop them
+  memh_cache_erase(base, seg_size);
+  if (memh_cache.size() >= (size_t)torch_ucc_config.memh_cache_size) {
+    memh_cache.erase(memh_lru.back());
+    memh_lru.pop_back();
+  }
+
+  ucp_mem_map_params_t params;
+  params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+      UCP_MEM_MAP_PARAM_FIELD_LENGTH | UCP_MEM_MAP_PARAM_FIELD_MEMORY_TYPE;
+  params.address = seg_base;
+  params.length = seg_size;
+  params.memory_type = mtype;
+  ucp_mem_h memh;
+  ucs_status_t st = ucp_mem_map(ucx_comm.context, &params, &memh);
+  if (st != UCS_OK) {
+    TORCH_UCC_LOG_DEBUG(
+        TORCH_UCC_COLL_POST,
+        c10::str("failed to register segment: ", ucs_status_string(st)));
+    return nullptr;
+  }
+  auto entry =
+      std::make_shared<torch_ucx_memh_t>(ucx_comm.context, memh, seg_size);
+  memh_lru.push_front(base);
+  memh_cache[base] = {entry, memh_lru.begin()};
+  return entry;
+}
+
+void CommPG::memh_cache_erase(uintptr_t base, size_t size) {
+  auto it = memh_cache.lower_bound(base);
+  if (it != memh_cache.begin()) {
+    auto prev = std::prev(it);
+    if (prev->first + prev->second.memh->size > base) {
+      it = prev;
+    }
+  }
+  while (it != memh_cache.end() && it->first < base + size) {
+    memh_lru.erase(it->second.lru);
+    it = memh_cache.erase(it);
+  }
+}
+
+void CommPG::memh_segment_freed(uintptr_t base, size_t size) {
+  std::lock_guard<std::mutex> lock(memh_caches_mutex);
+  for (CommPG* comm : memh_caches) {
+    std::lock_guard<std::mutex> freed_lock(comm->memh_freed_mutex);
+    if (comm->memh_freed.size() >= kMaxFreedRanges) {
+      // communicator doesn't look up registrations, drop all on next lookup
+      comm->memh_freed.assign(1, {0, SIZE_MAX});
+    }
+    comm->memh_freed.emplace_back(base, size);
+  }
 }
+#endif
 
-ucc_coll_req_h CommPG::send_nb(
+std::shared_ptr<ProcessGroupUCC::ProgressEntry> CommPG::send_nb(
     ucp_ep_h ep,
     void* data,
     ucs_memory_type_t mtype,
     size_t size,
-    ucp_tag_t ucp_tag) {
+    ucp_tag_t ucp_tag,
+    std::shared_ptr<ProcessGroupUCCMetrics> metrics) {
+  auto entry = std::allocate_shared<ProcessGroupUCC::ProgressEntry>(
+      SlabAllocator<ProcessGroupUCC::ProgressEntry>(), &ucx_comm, nullptr);
+  if (metrics) {
+    // progress thread may complete the request as soon as it is posted,
+    // setup time of p2p is negligible so post time is taken before
+    entry->metrics_ = std::move(metrics);
+    entry->sample_.op = OpType::SEND;
+    entry->sample_.bytes = size;
+    entry->sample_.enqueue_ns = entry->sample_.post_ns = torch_ucc_now_ns();
+  }
+  if (torch_ucc_config.use_future) {
+    // created before posting, callback can complete the entry at any time
+    entry->future_ = c10::make_intrusive<at::ivalue::Future>(
+        c10::ListType::create(c10::TensorType::get()));
+  }
+  auto req = new torch_ucx_p2p_req_t(entry);
   ucs_status_ptr_t st;
   ucp_request_param_t params;
   params.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
-      UCP_OP_ATTR_FIELD_DATATYPE | UCP_OP_ATTR_FIELD_MEMORY_TYPE;
+      UCP_OP_ATTR_FIELD_USER_DATA | UCP_OP_ATTR_FIELD_DATATYPE |
+      UCP_OP_ATTR_FIELD_MEMORY_TYPE;
   params.datatype = ucp_dt_make_contig(size);
   params.memory_type = mtype;
+  params.user_data = req;
   params.cb.send = [](void* request, ucs_status_t status, void* user_data) {
-    static_cast<ucc_coll_req_h>(request)->status = UCC_OK;
+    p2p_complete(
+        static_cast<torch_ucx_p2p_req_t*>(user_data), request, status, nullptr);
   };
+#ifdef TORCH_UCX_MEMH_CACHE
+  set_memh(this, req, params, data, size, mtype);
+#endif
   st = ucp_tag_send_nbx(ep, data, 1, ucp_tag, &params);
   if (UCS_PTR_IS_ERR(st)) {
+    delete req;
     TORCH_UCC_LOG_ERROR(
         TORCH_UCC_COLL_POST,
         c10::str(
             "failed to send message: ", ucs_status_string(UCS_PTR_STATUS(st))));
     throw std::runtime_error(ucs_status_string(UCS_PTR_STATUS(st)));
   }
-  return reinterpret_cast<ucc_coll_req_h>(st);
+  if (st == nullptr) {
+    p2p_complete(req, nullptr, UCS_OK, nullptr);
+  } else if (use_eager(size)) {
+    ucx_progress_eager(*entry);
+  }
+  return entry;
 }
 
-ucc_coll_req_h CommPG::recv_nb(
+std::shared_ptr<ProcessGroupUCC::ProgressEntry> CommPG::recv_nb(
     void* data,
     ucs_memory_type_t mtype,
     size_t size,
     ucp_tag_t ucp_tag,
-    ucp_tag_t ucp_tag_mask) {
+    ucp_tag_t ucp_tag_mask,
+    std::shared_ptr<ProcessGroupUCCMetrics> metrics) {
+  auto entry = std::allocate_shared<ProcessGroupUCC::ProgressEntry>(
+      SlabAllocator<ProcessGroupUCC::ProgressEntry>(), &ucx_comm, nullptr);
+  if (metrics) {
+    entry->metrics_ = std::move(metrics);
+    entry->sample_.op = ucp_tag_mask == TORCH_UCX_ANY_SOURCE_MASK
+        ? OpType::RECVANYSOURCE
+        : OpType::RECV;
+    entry->sample_.bytes = size;
+    entry->sample_.enqueue_ns = entry->sample_.post_ns = torch_ucc_now_ns();
+  }
+  if (torch_ucc_config.use_future) {
+    entry->future_ = c10::make_intrusive<at::ivalue::Future>(
+        c10::ListType::create(c10::TensorType::get()));
+  }
+  auto req = new torch_ucx_p2p_req_t(entry);
   ucs_status_ptr_t st;
   ucp_request_param_t params;
   params.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
-      UCP_OP_ATTR_FIELD_DATATYPE | UCP_OP_ATTR_FIELD_MEMORY_TYPE;
+      UCP_OP_ATTR_FIELD_USER_DATA | UCP_OP_ATTR_FIELD_DATATYPE |
+      UCP_OP_ATTR_FIELD_MEMORY_TYPE;
+#if UCP_API_VERSION >= UCP_VERSION(1, 11)
+  // sender of immediately completed receive
+  params.op_attr_mask |= UCP_OP_ATTR_FIELD_RECV_INFO;
+  params.recv_info.tag_info = &req->info;
+#else
+  params.op_attr_mask |= UCP_OP_ATTR_FLAG_NO_IMM_CMPL;
+#endif
   params.datatype = ucp_dt_make_contig(size);
+  params.user_data = req;
   params.cb.recv = [](void* request,
                       ucs_status_t status,
                       const ucp_tag_recv_info_t* info,
                       void* user_data) {
-    static_cast<ucc_coll_req_h>(request)->status = UCC_OK;
+    p2p_complete(
+        static_cast<torch_ucx_p2p_req_t*>(user_data), request, status, info);
   };
   params.memory_type = mtype;
+#ifdef TORCH_UCX_MEMH_CACHE
+  set_memh(this, req, params, data, size, mtype);
+#endif
   st = ucp_tag_recv_nbx(
       ucx_comm.worker, data, 1, ucp_tag, ucp_tag_mask, &params);
   if (UCS_PTR_IS_ERR(st)) {
+    delete req;
     TORCH_UCC_LOG_ERROR(
         TORCH_UCC_COLL_POST,
         c10::str(
             "failed to recv message: ", ucs_status_string(UCS_PTR_STATUS(st))));
     throw std::runtime_error(ucs_status_string(UCS_PTR_STATUS(st)));
   }
-  return reinterpret_cast<ucc_coll_req_h>(st);
+  if (st == nullptr) {
+    p2p_complete(req, nullptr, UCS_OK, &req->info);
+  } else if (use_eager(size)) {
+    ucx_progress_eager(*entry);
+  }
+  return entry;
 }
 
 void CommPG::ucc_create_team(
@@ -551,9 +1695,7 @@ void CommPG::ucc_create_team(
 }
 
 void CommPG::ucc_destroy_team(ucc_team_h& team) {
-  std::unique_lock<std::mutex> lock(mutex);
-  queue_consume_cv.wait(
-      lock, [&] { return progress_queue.empty() && !collective_inprogress; });
+  wait_for_drain();
 
   ucc_status_t status;
   while (UCC_INPROGRESS == (status = ucc_team_destroy(team))) {
@@ -564,35 +1706,143 @@ void CommPG::ucc_destroy_team(ucc_team_h& team) {
       break;
     }
   }
+}
 
-  lock.unlock();
+void CommPG::ucc_acquire_team(
+    ucc_team_h& team,
+    std::shared_ptr<torch_ucx_eps_t>& eps,
+    std::shared_ptr<torch_ucc_oob_coll_info_t> oob,
+    c10::Device dev) {
+  // ordered list of process ids identifies the team independently of the
+  // store prefix used by the group. The key isn't known before the exchange,
+  // so every rank also announces its cached teams of the same size and
+  // device that have it at its rank, one exchange tells which keys all ranks
+  // still have. Announced teams are pinned so they survive until then.
+  const std::string dev_key = dev.str();
+  const size_t uids_len = oob->size * sizeof(uint64_t);
+  torch_ucc_team_probe_t probe = {};
+  probe.uid = process_uid();
+  struct pinned_team_t {
+    std::string key;
+    ucc_team_h team;
+    std::shared_ptr<torch_ucx_eps_t> eps;
+  };
+  std::vector<pinned_team_t> pinned;
+  {
+    std::lock_guard<std::mutex> lock(team_cache_mutex);
+    int n = 0;
+    for (auto it = team_cache.begin();
+         it != team_cache.end() && n < kTeamCacheProbe;
+         ++it) {
+      const std::string& cached = it->first;
+      uint64_t cached_uid;
+      if (cached.size() != uids_len + dev_key.size() ||
+          cached.compare(uids_len, std::string::npos, dev_key) != 0) {
+        continue;
+      }
+      memcpy(
+          &cached_uid,
+          cached.data() + oob->rank * sizeof(uint64_t),
+          sizeof(uint64_t));
+      if (cached_uid == probe.uid) {
+        probe.cached[n++] = team_key_hash(cached);
+        it->second.refs++;
+        pinned.push_back({cached, it->second.team, it->second.eps});
+      }
+    }
+  }
+  std::vector<torch_ucc_team_probe_t> probes(oob->size);
+  try {
+    oob_allgather_sync(oob.get(), &probe, probes.data(), sizeof(probe));
+  } catch (...) {
+    for (auto& p : pinned) {
+      ucc_release_team(p.team, p.eps, oob);
+    }
+    throw;
+  }
+  std::string key(uids_len, '\0');
+  for (int i = 0; i < oob->size; i++) {
+    memcpy(&key[i * sizeof(uint64_t)], &probes[i].uid, sizeof(uint64_t));
+  }
+  key += dev_key;
+
+  // a rank might have already destroyed its copy, reuse only if all have it
+  const uint64_t hash = team_key_hash(key);
+  const bool all_hit = std::all_of(
+      probes.begin(), probes.end(), [hash](const torch_ucc_team_probe_t& p) {
+        return std::find(p.cached, p.cached + kTeamCacheProbe, hash) !=
+            p.cached + kTeamCacheProbe;
+      });
+  bool reused = false;
+  for (auto& p : pinned) {
+    if (all_hit && !reused && p.key == key) {
+      // pin becomes the reference of this group
+      reused = true;
+      team = p.team;
+      eps = p.eps;
+      continue;
+    }
+    // last reference of a team released meanwhile destroys it here
+    ucc_release_team(p.team, p.eps, oob);
+  }
+  TORCH_CHECK(
+      reused || !all_hit, "UCC team cache key hash collision on this rank");
+  if (reused) {
+    TORCH_UCC_LOG_INFO(TORCH_UCC_INIT, "reusing cached UCC team");
+    return;
+  }
+
+  eps = std::make_shared<torch_ucx_eps_t>();
+  ucx_connect_eps(*eps, oob);
+  ucc_create_team(team, oob);
+  std::lock_guard<std::mutex> lock(team_cache_mutex);
+  if (team_cache.find(key) == team_cache.end()) {
+    team_cache[key] = {team, eps, oob, 1};
+  }
+}
+
+void CommPG::ucc_release_team(
+    ucc_team_h& team,
+    std::shared_ptr<torch_ucx_eps_t>& eps,
+    std::shared_ptr<torch_ucc_oob_coll_info_t> oob) {
+  // teams that didn't make it into the cache are owned by a single group
+  std::shared_ptr<torch_ucc_oob_coll_info_t> owner_oob = oob;
+  {
+    std::lock_guard<std::mutex> lock(team_cache_mutex);
+    for (auto it = team_cache.begin(); it != team_cache.end(); ++it) {
+      if (it->second.team != team) {
+        continue;
+      }
+      if (--it->second.refs > 0) {
+        team = nullptr;
+        return;
+      }
+      owner_oob = it->second.oob;
+      team_cache.erase(it);
+      break;
+    }
+  }
+  ucc_destroy_team(team);
+  team = nullptr;
+  ucx_disconnect_eps(*eps, owner_oob);
 }
 
 c10::intrusive_ptr<ProcessGroup::Work> CommPG::enqueue_p2p(
     OpType opType,
-    ucc_coll_req_h request,
-    const char* prof_title) {
+    std::shared_ptr<ProcessGroupUCC::ProgressEntry> entry,
+    const char* prof_title,
+    std::chrono::milliseconds timeout) {
   auto work = c10::make_intrusive<ProcessGroupUCC::WorkUCC>(
       opType, prof_title, logger);
-  if (torch_ucc_config.use_future) {
-    work->future_ = c10::make_intrusive<at::ivalue::Future>(
-        c10::ListType::create(c10::TensorType::get()));
-  }
-  if (request == nullptr) {
-    // p2p2 request completed immediately don't save it to progress queue
-    // and mark future completed immediately
-    if (torch_ucc_config.use_future) {
-      work->future_->markCompleted(c10::IValue(std::vector<at::Tensor>()));
-    }
+  work->default_timeout_ = timeout;
+  work->future_ = entry->future_;
+  work->entry_ = entry;
+  if (entry->completed_) {
+    // p2p request completed immediately don't save it to progress queue
+    entry->completeFuture();
     return work;
   }
-  auto entry =
-      std::make_shared<ProcessGroupUCC::ProgressEntry>(&ucx_comm, request);
-  work->entry_ = entry;
-  std::unique_lock<std::mutex> lock(mutex);
-  progress_queue.push_back(entry);
-  lock.unlock();
-  queue_produce_cv.notify_one();
+  submit(std::move(entry), work);
   return work;
 }
 
@@ -600,21 +1850,38 @@ void CommPG::enqueue_collective(
     std::unique_ptr<ProcessGroupUCC::WorkData> data,
     c10::intrusive_ptr<ProcessGroupUCC::WorkUCC> work,
     ucc_coll_args_t& coll,
-    ucc_team_h team) {
+    ucc_team_h team,
+    std::shared_ptr<ProcessGroupUCC::PersistentCollective> persistent,
+    size_t size) {
   ucc_coll_req_h request;
-  TORCH_UCC_CHECK(
-      ucc_collective_init(&coll, &request, team), "failed to init collective");
-  TORCH_UCC_CHECK(ucc_collective_post(request), "failed to post collective");
+  if (persistent) {
+    request = persistent->request;
+  } else {
+    TORCH_UCC_CHECK(
+        ucc_collective_init(&coll, &request, team),
+        "failed to init collective");
+  }
+  ucc_status_t st = ucc_collective_post(request);
+  if (st != UCC_OK && persistent) {
+    persistent->inflight = false;
+  }
+  TORCH_UCC_CHECK(st, "failed to post collective");
 
-  auto entry =
-      std::make_shared<ProcessGroupUCC::ProgressEntry>(&ucc_comm, request);
+  auto entry = std::allocate_shared<ProcessGroupUCC::ProgressEntry>(
+      SlabAllocator<ProcessGroupUCC::ProgressEntry>(), &ucc_comm, request);
   entry->data = std::move(data);
+  entry->persistent_ = std::move(persistent);
+  if (work->metrics_) {
+    entry->metrics_ = work->metrics_;
+    entry->sample_ = work->sample_;
+    entry->sample_.post_ns = torch_ucc_now_ns();
+  }
   entry->future_ = work->getFuture();
   work->entry_ = entry;
-  std::unique_lock<std::mutex> lock(mutex);
-  progress_queue.push_back(entry);
-  lock.unlock();
-  queue_produce_cv.notify_one();
+  if (use_eager(size) && progress_eager(*entry)) {
+    return;
+  }
+  submit(std::move(entry), work);
 }
 
 #ifdef USE_CUDA
@@ -623,76 +1890,280 @@ void CommPG::enqueue_cuda_collective(
     c10::intrusive_ptr<ProcessGroupUCC::WorkUCC> work,
     ucc_coll_args_t& coll,
     ucc_team_h team,
-    ucc_ee_h ee) {
+    ucc_ee_h ee,
+    std::shared_ptr<ProcessGroupUCC::PersistentCollective> persistent,
+    std::shared_ptr<ProcessGroupUCC::ProgressEntry>* captured) {
   ucc_coll_req_h request;
-  TORCH_UCC_CHECK(
-      ucc_collective_init(&coll, &request, team),
-      "failed to init cuda collective");
+  if (persistent) {
+    request = persistent->request;
+  } else {
+    TORCH_UCC_CHECK(
+        ucc_collective_init(&coll, &request, team),
+        "failed to init cuda collective");
+  }
   ucc_ev_t comp_ev, *post_ev;
   comp_ev.ev_type = UCC_EVENT_COMPUTE_COMPLETE;
   comp_ev.ev_context = nullptr;
   comp_ev.ev_context_size = 0;
   comp_ev.req = request;
-  TORCH_UCC_CHECK(
-      ucc_collective_triggered_post(ee, &comp_ev),
-      "failed to post triggered collective");
-  ucc_status_t st = ucc_ee_get_event(ee, &post_ev);
+  ucc_status_t st = ucc_collective_triggered_post(ee, &comp_ev);
+  if (st != UCC_OK && persistent) {
+    persistent->inflight = false;
+  }
+  TORCH_UCC_CHECK(st, "failed to post triggered collective");
+  st = ucc_ee_get_event(ee, &post_ev);
   TORCH_CHECK(st == UCC_OK && post_ev->ev_type == UCC_EVENT_COLLECTIVE_POST);
   ucc_ee_ack_event(ee, post_ev);
-  auto entry =
-      std::make_shared<ProcessGroupUCC::ProgressEntry>(&ucc_comm, request);
+  auto entry = std::allocate_shared<ProcessGroupUCC::ProgressEntry>(
+      SlabAllocator<ProcessGroupUCC::ProgressEntry>(), &ucc_comm, request);
   entry->data = std::move(data);
+  entry->persistent_ = std::move(persistent);
+  if (work->metrics_) {
+    entry->metrics_ = work->metrics_;
+    entry->sample_ = work->sample_;
+    entry->sample_.post_ns = torch_ucc_now_ns();
+  }
+  if (captured) {
+    *captured = std::move(entry);
+    return;
+  }
+  entry->future_ = work->getFuture();
   work->entry_ = entry;
-  std::unique_lock<std::mutex> lock(mutex);
-  progress_queue.push_back(entry);
-  lock.unlock();
-  queue_produce_cv.notify_one();
+  submit(std::move(entry), work);
 }
 #endif
 
-void CommPG::progress_loop() {
+void CommPG::submit(
+    std::shared_ptr<ProcessGroupUCC::ProgressEntry> entry,
+    const c10::intrusive_ptr<ProcessGroupUCC::WorkUCC>& work) {
+  // deferred entries count too, communicator can't drain before groupEnd
+  outstanding_requests++;
+  if (torch_ucc_group.depth > 0) {
+    torch_ucc_group.entries.emplace_back(this, std::move(entry));
+    torch_ucc_group.works.push_back(work);
+    return;
+  }
+  while (!progress_queue.try_push(entry)) {
+    // queue is full, let progress thread drain it
+    ring_doorbell();
+    std::this_thread::yield();
+  }
+  ring_doorbell();
+}
+
+bool CommPG::use_eager(size_t size) {
+  return size <= (size_t)torch_ucc_config.eager_threshold &&
+      torch_ucc_group.depth == 0 && outstanding_requests == 0;
+}
+
+bool CommPG::progress_eager(ProcessGroupUCC::ProgressEntry& entry) {
+  std::exception_ptr eptr;
+  try {
+    for (int i = 0; i < torch_ucc_config.eager_spin; i++) {
+      if (entry.request_->status <= 0) {
+        break;
+      }
+      ucc_comm.progress();
+    }
+  } catch (...) {
+    eptr = std::current_exception();
+  }
+  if (!eptr) {
+    if (entry.request_->status > 0) {
+      // hand it over to progress thread
+      return false;
+    }
+    if (entry.request_->status < 0) {
+      eptr = std::make_exception_ptr(
+          std::runtime_error(ucc_status_string(entry.request_->status)));
+      TORCH_UCC_LOG_ERROR(
+          TORCH_UCC_COLL_PROGRESS,
+          c10::str(
+              "Failed to progress communication",
+              ucc_status_string(entry.request_->status)));
+    }
+  }
+  entry.finalize(eptr);
+  return true;
+}
+
+void CommPG::ucx_progress_eager(ProcessGroupUCC::ProgressEntry& entry) {
+  for (int i = 0; i < torch_ucc_config.eager_spin && !entry.completed(); i++) {
+    ucx_comm.progress();
+  }
+}
+
+void CommPG::submit_batch(
+    std::vector<std::shared_ptr<ProcessGroupUCC::ProgressEntry>>& entries,
+    bool counted) {
+  if (!counted) {
+    outstanding_requests += entries.size();
+  }
+  for (auto& entry : entries) {
+    while (!progress_queue.try_push(entry)) {
+      ring_doorbell();
+      std::this_thread::yield();
+    }
+  }
+  ring_doorbell();
+}
+
+void CommPG::ring_doorbell() {
+  // pairs with the fence progress thread issues before going to sleep, either
+  // we see it sleeping or it sees the new entry
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  switch (progress_thread_state.load(std::memory_order_relaxed)) {
+    case TORCH_UCC_PROGRESS_SLEEP_CV: {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue_produce_cv.notify_one();
+      break;
+    }
+    case TORCH_UCC_PROGRESS_SLEEP_EFD:
+      ucp_worker_signal(ucx_comm.worker);
+      break;
+    default:
+      break;
+  }
+}
+
+void CommPG::request_done() {
+  if (--outstanding_requests == 0 && drain_waiters > 0) {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue_consume_cv.notify_all();
+  }
+}
+
+void CommPG::wait_for_drain() {
+  drain_waiters++;
   std::unique_lock<std::mutex> lock(mutex);
+  queue_consume_cv.wait(lock, [this] { return outstanding_requests == 0; });
+  drain_waiters--;
+}
+
+void CommPG::progress_loop() {
 #ifdef USE_CUDA
   bool device_set = false;
 #endif
+  // with negative spin time progress thread busy polls while there are
+  // requests in flight and sleeps as soon as queue is empty
+  const bool idle_policy = (torch_ucc_config.progress_spin_usec >= 0);
+  const auto spin_time =
+      std::chrono::microseconds(torch_ucc_config.progress_spin_usec);
+  auto last_activity = std::chrono::steady_clock::now();
+  int ucx_efd = -1;
+  if (idle_policy) {
+    ucs_status_t st = ucp_worker_get_efd(ucx_comm.worker, &ucx_efd);
+    if (st != UCS_OK) {
+      TORCH_UCC_LOG_ERROR(
+          TORCH_UCC_INIT,
+          c10::str(
+              "failed to get UCX worker event fd, progress thread will ",
+              "keep polling: ",
+              ucs_status_string(st)));
+      ucx_efd = -1;
+    }
+  }
+  // requests that were posted but have not completed yet, they are all
+  // checked on every progress tick and finalized in completion order
+  std::list<std::shared_ptr<ProcessGroupUCC::ProgressEntry>> inflight;
+  std::shared_ptr<ProcessGroupUCC::ProgressEntry> entry;
   while (!stop_progress_loop) {
-    if (progress_queue.empty()) {
-      queue_produce_cv.wait(lock);
+    if (inflight.empty() && progress_queue.empty()) {
+      if (idle_policy &&
+          std::chrono::steady_clock::now() - last_activity <= spin_time) {
+        // spin on the queue to save a wakeup for the next request
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      progress_thread_state = TORCH_UCC_PROGRESS_SLEEP_CV;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      queue_produce_cv.wait(
+          lock, [this] { return !progress_queue.empty() || stop_progress_loop; });
+      progress_thread_state = TORCH_UCC_PROGRESS_RUNNING;
+      last_activity = std::chrono::steady_clock::now();
       continue;
     }
-    collective_inprogress = true;
-    auto work = progress_queue.front();
-    progress_queue.pop_front();
-    lock.unlock();
+    while (progress_queue.try_pop(entry)) {
+      if (entry->metrics_) {
+        entry->progress_ns_.store(
+            torch_ucc_now_ns(), std::memory_order_relaxed);
+      }
+      inflight.push_back(std::move(entry));
+      last_activity = std::chrono::steady_clock::now();
+    }
 #ifdef USE_CUDA
     if ((!device_set) && (cuda_device_index != TORCH_UCC_DEVICE_NOT_SET)) {
       c10::cuda::set_device(cuda_device_index);
       device_set = true;
     }
 #endif
-    std::exception_ptr eptr;
+    std::exception_ptr progress_eptr;
     try {
-      while (work->request_->status > 0) {
-        ucc_comm.progress();
-        ucx_comm.progress();
-      }
-      if (work->request_->status < 0) {
-        eptr = std::make_exception_ptr(
-            std::runtime_error(ucc_status_string(work->request_->status)));
-        std::string err_log = c10::str(
-            "Failed to progress communication", // TODO: report exact op type or
-                                                // id?
-            ucc_status_string(work->request_->status));
-        TORCH_UCC_LOG_ERROR(TORCH_UCC_COLL_PROGRESS, err_log);
-      }
+      ucc_comm.progress();
+      ucx_comm.progress();
     } catch (...) {
-      eptr = std::current_exception();
+      // progress failure can't be attributed to a single request, fail all
+      // requests that are currently in flight
+      progress_eptr = std::current_exception();
+    }
+    for (auto it = inflight.begin(); it != inflight.end();) {
+      auto& work = *it;
+      std::exception_ptr eptr = progress_eptr;
+      if (!eptr && work->comm_ == &ucx_comm) {
+        // finalized by UCX completion callback, only retire it here
+        if (!work->completed_) {
+          ++it;
+          continue;
+        }
+      } else if (!eptr) {
+        if (work->request_->status > 0) {
+          ++it;
+          continue;
+        }
+        if (work->request_->status < 0) {
+          eptr = std::make_exception_ptr(
+              std::runtime_error(ucc_status_string(work->request_->status)));
+          std::string err_log = c10::str(
+              "Failed to progress communication", // TODO: report exact op type
+                                                  // or id?
+              ucc_status_string(work->request_->status));
+          TORCH_UCC_LOG_ERROR(TORCH_UCC_COLL_PROGRESS, err_log);
+        }
+      }
+      work->finalize(eptr);
+      // future of an entry finalized by UCX callback
+      work->completeFuture();
+      it = inflight.erase(it);
+      request_done();
+      last_activity = std::chrono::steady_clock::now();
+    }
+    if (inflight.empty() || ucx_efd < 0 ||
+        std::chrono::steady_clock::now() - last_activity <= spin_time) {
+      continue;
     }
-    work->finalize(eptr);
-    work = nullptr;
-    collective_inprogress = false;
-    queue_consume_cv.notify_one();
-    lock.lock();
+    // UCC requests have no event fd to wait on, only block when all requests
+    // in flight are driven by UCX worker
+    bool ucx_only = std::all_of(
+        inflight.begin(),
+        inflight.end(),
+        [this](const std::shared_ptr<ProcessGroupUCC::ProgressEntry>& e) {
+          return e->comm_ == &ucx_comm;
+        });
+    if (!ucx_only) {
+      continue;
+    }
+    progress_thread_state = TORCH_UCC_PROGRESS_SLEEP_EFD;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (progress_queue.empty() && !stop_progress_loop &&
+        ucp_worker_arm(ucx_comm.worker) == UCS_OK) {
+      struct pollfd pfd;
+      pfd.fd = ucx_efd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      poll(&pfd, 1, kBusyWaitMillis);
+    }
+    progress_thread_state = TORCH_UCC_PROGRESS_RUNNING;
+    last_activity = std::chrono::steady_clock::now();
   }
 }
 
@@ -708,7 +2179,16 @@ ProcessGroupUCC::ProcessGroupUCC(
   oob->size = size;
   oob->store = store;
   comm = nullptr;
+  eps = std::make_shared<torch_ucx_eps_t>();
   cuda_ee = nullptr;
+  persistent_enabled = torch_ucc_config.persistent_coll;
+  if (torch_ucc_config.enable_metrics) {
+    metrics = std::make_shared<ProcessGroupUCCMetrics>();
+  }
+  if (torch_ucc_config.memory_saving) {
+    buffer_pool =
+        std::make_shared<BufferPool>(torch_ucc_config.buffer_pool_size);
+  }
   static uint32_t id = 0;
   uint32_t pg_id = (id++ % TORCH_UCX_MAX_COMM);
 
@@ -737,32 +2217,79 @@ ProcessGroupUCC::ProcessGroupUCC(
     runHealthCheck();
   }
   if (torch_ucc_config.enable_comms_logger) {
-    logger->initCommsTracer();
+    logger->initCommsTracer(this->getRank(), this->getSize());
+  }
+  if (torch_ucc_config.async_init) {
+    initCommAsync();
   }
 }
 
 ProcessGroupUCC::~ProcessGroupUCC() {
+#ifdef TORCH_UCC_SEGMENT_EVENTS
+  {
+    std::lock_guard<std::mutex> lock(persistent_caches_mutex);
+    persistent_caches.erase(
+        std::remove(persistent_caches.begin(), persistent_caches.end(), this),
+        persistent_caches.end());
+  }
+#endif
   if (torch_ucc_config.enable_comms_logger) {
     logger->flushComms(this->getRank(), this->getSize());
   }
+  if (init_thread.joinable()) {
+    init_thread.join();
+  }
   if (comm) {
     logger->setPhase(TORCH_UCC_FINALIZE);
-    comm->ucc_destroy_team(team);
-    TORCH_UCC_LOG_INFO(
-        TORCH_UCC_FINALIZE, "Successfully destroyed UCC library");
-    comm->ucx_disconnect_eps(eps, oob);
-    TORCH_UCC_LOG_INFO(
-        TORCH_UCC_FINALIZE, "Successfully destroyed UCX library");
+#ifdef USE_CUDA
+    submitCapturedEntries();
+#endif
+    // cached requests belong to the team, release them before destroying it
+    comm->wait_for_drain();
+    clearPersistentCollectives();
+    captured_persistent.clear();
+    for (auto& helper : cpu_helpers) {
+      if (helper.team) {
+        helper.comm->ucc_destroy_team(helper.team);
+      }
+    }
+    cpu_helpers.clear();
+#ifdef USE_CUDA
+    if (hier.intra) {
+      comm->ucc_destroy_team(hier.intra);
+    }
+    if (hier.inter) {
+      comm->ucc_destroy_team(hier.inter);
+    }
+#endif
+    if (torch_ucc_config.team_cache) {
+      if (team) {
+        comm->ucc_release_team(team, eps, oob);
+      }
+    } else {
+      if (team) {
+        comm->ucc_destroy_team(team);
+      }
+      TORCH_UCC_LOG_INFO(
+          TORCH_UCC_FINALIZE, "Successfully destroyed UCC library");
+      comm->ucx_disconnect_eps(*eps, oob);
+      TORCH_UCC_LOG_INFO(
+          TORCH_UCC_FINALIZE, "Successfully destroyed UCX library");
+    }
     try {
       if (cuda_ee) {
         ucc_ee_destroy(cuda_ee);
       }
-      if ((size_t)oob->store->add(oob->getKey("ucc_pg_closed"), 1) ==
-          eps.size()) {
-        std::vector<uint8_t> val = {1};
-        oob->store->set(oob->getKey("ucc_pg_finished"), val);
-      } else {
-        oob->store->wait({oob->getKey("ucc_pg_finished")});
+      // with fast exit job is torn down anyway, don't wait for other ranks.
+      // Ranks whose initialization failed still take part, peers would wait
+      // for them forever otherwise.
+      if (!torch_ucc_config.fast_exit) {
+        if (oob->store->add(oob->getKey("ucc_pg_closed"), 1) == size_) {
+          std::vector<uint8_t> val = {1};
+          oob->store->set(oob->getKey("ucc_pg_finished"), val);
+        } else {
+          oob->store->wait({oob->getKey("ucc_pg_finished")});
+        }
       }
     } catch (std::exception& ex) {
       TORCH_UCC_LOG_INFO(
@@ -818,7 +2345,7 @@ void ProcessGroupUCC::runHealthCheck() {
         oob->size = this->oob->size;
         oob->store = this->oob->store;
 
-        std::vector<ucp_ep_h> eps;
+        torch_ucx_eps_t eps;
         ucc_team_h team = nullptr;
         uint32_t comm_id;
 #ifdef USE_CUDA
@@ -827,7 +2354,8 @@ void ProcessGroupUCC::runHealthCheck() {
         }
 #endif
         auto comm = CommPG::get_comm(comm_id, device, oob, logger, true);
-        comm->ucx_connect_eps(eps, oob);
+        // create all endpoints to check connectivity with every rank
+        comm->ucx_connect_eps(eps, oob, false);
         comm->ucx_disconnect_eps(eps, oob);
         TORCH_UCC_LOG_INFO(
             TORCH_UCC_HEALTH_CHECK,
@@ -898,6 +2426,194 @@ void ProcessGroupUCC::runHealthCheck() {
       rank_);
 }
 
+ProcessGroupUCC::PersistentCollective::~PersistentCollective() {
+  if (request != nullptr) {
+    ucc_status_t st = ucc_collective_finalize(request);
+    if (st != UCC_OK) {
+      LOG(ERROR) << "failed to finalize persistent collective: "
+                 << ucc_status_string(st);
+    }
+  }
+}
+
+void ProcessGroupUCC::setPersistentCollectives(bool enable) {
+  persistent_enabled = enable;
+  if (!enable) {
+    clearPersistentCollectives();
+  }
+}
+
+void ProcessGroupUCC::clearMemhCache() {
+#ifdef TORCH_UCX_MEMH_CACHE
+  // whole address space
+  CommPG::memh_segment_freed(0, SIZE_MAX);
+#endif
+}
+
+void ProcessGroupUCC::setCompressionBucket(int64_t bucket) {
+  torch_ucc_compression_bucket = bucket;
+}
+
+int64_t ProcessGroupUCC::takeCompressionBucket() {
+  const int64_t bucket = torch_ucc_compression_bucket;
+  torch_ucc_compression_bucket = -1;
+  return bucket;
+}
+
+void ProcessGroupUCC::groupStart() {
+  torch_ucc_group.depth++;
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::groupEnd() {
+  TORCH_CHECK(torch_ucc_group.depth > 0, "groupEnd called without groupStart");
+  if (--torch_ucc_group.depth > 0) {
+    return c10::make_intrusive<GroupWorkUCC>(
+        std::vector<c10::intrusive_ptr<WorkUCC>>());
+  }
+  auto group_entries = std::move(torch_ucc_group.entries);
+  auto works = std::move(torch_ucc_group.works);
+  torch_ucc_group.entries.clear();
+  torch_ucc_group.works.clear();
+  torch_ucc_group_submit(group_entries);
+  return c10::make_intrusive<GroupWorkUCC>(std::move(works));
+}
+
+void ProcessGroupUCC::clearPersistentCollectives() {
+  // requests in flight are released when their last entry completes
+  std::lock_guard<std::mutex> lock(persistent_mutex);
+  persistent_colls.clear();
+  persistent_lru.clear();
+}
+
+std::shared_ptr<ProcessGroupUCC::PersistentCollective>
+ProcessGroupUCC::get_persistent_collective(
+    const ucc_coll_args_t& coll,
+    bool captured) {
+  std::string key;
+  if (!persistent_coll_key(coll, size_, key)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(persistent_mutex);
+#ifdef TORCH_UCC_SEGMENT_EVENTS
+  persistent_cache_erase_freed();
+#endif
+  auto it = persistent_colls.find(key);
+  if (it != persistent_colls.end()) {
+    persistent_lru.splice(persistent_lru.begin(), persistent_lru, it->second);
+    auto cached = it->second->second;
+    bool expected = false;
+    if (cached->inflight.compare_exchange_strong(expected, true)) {
+      if (captured) {
+        captured_persistent.push_back(cached);
+      }
+      return cached;
+    }
+    // previous instance is still running, initialize a request for this
+    // call only. Whether a request is reused depends on local buffers and
+    // timing, so ranks must not fall back to a regular collective here.
+  }
+
+  auto persistent = std::make_shared<PersistentCollective>();
+  ucc_coll_args_t args = coll;
+  args.mask |= UCC_COLL_ARGS_FIELD_FLAGS;
+  args.flags |= UCC_COLL_ARGS_FLAG_PERSISTENT;
+  // arrays of v-collectives are owned by work data of the current call,
+  // request needs its own copy
+  persistent->counts.reserve(4);
+  auto copy_v = [&](ucc_coll_buffer_info_v_t& info) {
+    auto counts = reinterpret_cast<uint64_t*>(info.counts);
+    auto displs = reinterpret_cast<uint64_t*>(info.displacements);
+    persistent->counts.emplace_back(counts, counts + size_);
+    info.counts = (ucc_count_t*)persistent->counts.back().data();
+    persistent->counts.emplace_back(displs, displs + size_);
+    info.displacements = (ucc_aint_t*)persistent->counts.back().data();
+  };
+  if (args.coll_type == UCC_COLL_TYPE_ALLTOALLV) {
+    copy_v(args.src.info_v);
+  }
+  if (args.coll_type == UCC_COLL_TYPE_ALLTOALLV ||
+      args.coll_type == UCC_COLL_TYPE_ALLGATHERV) {
+    copy_v(args.dst.info_v);
+  }
+  ucc_status_t st = ucc_collective_init(&args, &persistent->request, team);
+  if (st != UCC_OK) {
+    // not every TL supports persistent collectives
+    TORCH_UCC_LOG_DEBUG(
+        TORCH_UCC_COLL_POST,
+        c10::str(
+            "failed to init persistent collective: ", ucc_status_string(st)));
+    persistent->request = nullptr;
+    return nullptr;
+  }
+  persistent->inflight = true;
+  if (captured) {
+    captured_persistent.push_back(persistent);
+  }
+  if (it != persistent_colls.end() ||
+      torch_ucc_config.persistent_cache_size <= 0) {
+    // one-off request, finalized when its collective completes
+    return persistent;
+  }
+#ifdef TORCH_UCC_SEGMENT_EVENTS
+  persistent->buffers = persistent_coll_buffers(coll, size_);
+  if (!persistent->buffers.empty()) {
+    // allocator is initialized once it handed out a CUDA buffer
+    std::call_once(persistent_attached, [this]() {
+      segment_tracker_attach();
+      std::lock_guard<std::mutex> caches_lock(persistent_caches_mutex);
+      persistent_caches.push_back(this);
+    });
+  }
+#endif
+  persistent_lru.emplace_front(key, persistent);
+  persistent_colls.emplace(std::move(key), persistent_lru.begin());
+  while (persistent_lru.size() >
+         (size_t)torch_ucc_config.persistent_cache_size) {
+    // requests in flight are finalized when their last entry completes
+    persistent_colls.erase(persistent_lru.back().first);
+    persistent_lru.pop_back();
+  }
+  return persistent;
+}
+
+#ifdef TORCH_UCC_SEGMENT_EVENTS
+void ProcessGroupUCC::persistent_cache_erase_freed() {
+  std::vector<std::pair<uintptr_t, size_t>> freed;
+  {
+    std::lock_guard<std::mutex> freed_lock(persistent_freed_mutex);
+    freed.swap(persistent_freed);
+  }
+  if (freed.empty()) {
+    return;
+  }
+  for (auto it = persistent_lru.begin(); it != persistent_lru.end();) {
+    if (ranges_overlap(it->second->buffers, freed)) {
+      // requests in flight are released when their last entry completes
+      persistent_colls.erase(it->first);
+      it = persistent_lru.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ProcessGroupUCC::persistent_segment_freed(uintptr_t base, size_t size) {
+  std::lock_guard<std::mutex> lock(persistent_caches_mutex);
+  for (ProcessGroupUCC* pg : persistent_caches) {
+    std::lock_guard<std::mutex> freed_lock(pg->persistent_freed_mutex);
+    if (pg->persistent_freed.size() >= kMaxFreedRanges) {
+      // group doesn't post cached collectives, drop all on next lookup
+      pg->persistent_freed.assign(1, {0, SIZE_MAX});
+    }
+    pg->persistent_freed.emplace_back(base, size);
+  }
+}
+#endif
+
+std::chrono::milliseconds ProcessGroupUCC::default_wait_timeout() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(timeout_);
+}
+
 void ProcessGroupUCC::set_timeout(ucc_coll_args_t& args) {
   args.mask |= UCC_COLL_ARGS_FIELD_FLAGS;
   args.flags |= UCC_COLL_ARGS_FLAG_TIMEOUT;
@@ -916,6 +2632,51 @@ std::unique_ptr<at::cuda::CUDAEvent> ProcessGroupUCC::getPooledEvent() {
 	}
 	return ev;
 }
+
+bool ProcessGroupUCC::is_capturing(c10::Device dev) {
+  cudaStreamCaptureStatus status;
+  C10_CUDA_CHECK(cudaStreamIsCapturing(
+      at::cuda::getCurrentCUDAStream(dev.index()).stream(), &status));
+  return status != cudaStreamCaptureStatusNone;
+}
+
+std::unique_ptr<at::cuda::CUDAEvent> ProcessGroupUCC::getCaptureEvent() {
+  refill_capture_events = true;
+  std::lock_guard<std::mutex> lock(capture_mutex);
+  if (capture_events.empty()) {
+    // created by its first record, event creation is legal while capturing
+    return std::make_unique<at::cuda::CUDAEvent>();
+  }
+  auto ev = std::move(capture_events.back());
+  capture_events.pop_back();
+  return ev;
+}
+
+void ProcessGroupUCC::refillCaptureEvents() {
+  std::lock_guard<std::mutex> lock(capture_mutex);
+  while (capture_events.size() < kCaptureEvents) {
+    // recorded once so they are created before any capture starts
+    capture_events.push_back(std::make_unique<at::cuda::CUDAEvent>());
+    capture_events.back()->record(*stream);
+  }
+}
+
+void ProcessGroupUCC::submitCapturedEntries() {
+  if (!has_captured.load(std::memory_order_relaxed)) {
+    return;
+  }
+  std::vector<std::shared_ptr<ProgressEntry>> entries;
+  {
+    std::lock_guard<std::mutex> lock(capture_mutex);
+    entries.swap(captured_entries);
+    has_captured = false;
+  }
+  if (!entries.empty()) {
+    // events of captured collectives are never recorded outside the graph,
+    // requests complete without waiting for a replay
+    comm->submit_batch(entries);
+  }
+}
 #endif
 
 template <typename PreProcess, typename PostProcess>
@@ -929,9 +2690,37 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::collective_post(
     std::vector<at::Tensor> &inputTensors,
     std::vector<at::Tensor> &outputTensors,
     const char* prof_title) {
+  torch_ucc_group_error_guard group_guard;
+#ifdef USE_CUDA
+  // captured collectives are always a single persistent request when the TL
+  // supports it, the graph refers to the request for as long as it lives
+  const bool captured = dev.is_cuda() && is_capturing(dev);
+  if (!captured) {
+    submitCapturedEntries();
+  }
+#else
+  const bool captured = false;
+#endif
+  if ((torch_ucc_config.tune || !torch_ucc_config.tune_file.empty()) &&
+      !tune_table.started(dev.type()) && !captured &&
+      torch_ucc_group.depth == 0) {
+    // all ranks post the same first collective on a device
+    autotune(dev);
+  }
+  if (captured && data) {
+    data->keep_buffers = true;
+  }
   set_timeout(coll);
   auto work = c10::make_intrusive<ProcessGroupUCC::WorkUCC>(
       opType, torch_ucc_config.enable_profiling ? prof_title : nullptr, logger);
+  work->default_timeout_ = default_wait_timeout();
+  if (metrics) {
+    work->metrics_ = metrics;
+    work->sample_.op = opType;
+    work->sample_.bytes =
+        std::max(tensors_nbytes(inputTensors), tensors_nbytes(outputTensors));
+    work->sample_.enqueue_ns = torch_ucc_now_ns();
+  }
 
   RECORD_COMMS_TRACE(
       logger->trace_generator,
@@ -942,6 +2731,34 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::collective_post(
       inputTensors,
       outputTensors);
 
+#ifdef USE_CUDA
+  const bool hier =
+      dev.is_cuda() && !captured && use_hier_allreduce(coll, inputTensors);
+#else
+  const bool hier = false;
+#endif
+  const bool single = hier || captured ||
+      tune_table.choice(
+          TORCH_UCC_TUNE_CHUNKING, dev.type(), tensors_nbytes(inputTensors)) ==
+          0;
+  const size_t chunks = single ? 1
+      : dev.is_cuda()          ? num_coll_chunks(coll, inputTensors)
+                               : num_cpu_shards(coll, inputTensors);
+  std::shared_ptr<PersistentCollective> persistent =
+      ((persistent_enabled || captured) && chunks == 1 && !hier)
+      ? get_persistent_collective(coll, captured)
+      : nullptr;
+  // request is idle again if posting fails before it is handed over, enqueue
+  // takes persistent and handles failures itself
+  struct InflightGuard {
+    std::shared_ptr<PersistentCollective>& persistent;
+    ~InflightGuard() {
+      if (persistent) {
+        persistent->inflight = false;
+      }
+    }
+  } inflight_guard{persistent};
+
   // Store references to outputs to be used by result
   work->outputs_ = std::make_shared<std::vector<at::Tensor>>(outputTensors);
   switch (dev.type()) {
@@ -950,22 +2767,87 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::collective_post(
         work->future_ = c10::make_intrusive<at::ivalue::Future>(
             c10::ListType::create(c10::TensorType::get()));
       }
-      comm->enqueue_collective(std::move(data), work, coll, team);
+      preproc();
+      if (chunks > 1) {
+        enqueue_sharded_collective(
+            std::move(data),
+            work,
+            coll,
+            inputTensors[0].element_size(),
+            chunks);
+        return work;
+      }
+      comm->enqueue_collective(
+          std::move(data),
+          work,
+          coll,
+          team,
+          std::move(persistent),
+          std::max(tensors_nbytes(inputTensors), tensors_nbytes(outputTensors)));
       return work;
     }
 #ifdef USE_CUDA
     case c10::DeviceType::CUDA: {
-      auto cuda_ev = getPooledEvent();
-      cuda_ev->record(at::cuda::getCurrentCUDAStream(dev.index()));
-      cuda_ev->block(*stream);
+      const bool host_completion = data && data->host_completion;
+      if (host_completion && torch_ucc_config.use_future) {
+        // completed by the progress thread as for CPU collectives
+        work->future_ = c10::make_intrusive<at::ivalue::Future>(
+            c10::ListType::create(c10::TensorType::get()));
+      }
+      std::unique_ptr<at::cuda::CUDAEvent> cuda_ev;
+      if (captured) {
+        cuda_ev = getCaptureEvent();
+      } else {
+        if (refill_capture_events.exchange(false)) {
+          refillCaptureEvents();
+        }
+        cuda_ev = getPooledEvent();
+      }
+      at::cuda::CUDAEvent* ev = cuda_ev.get();
+      ev->record(at::cuda::getCurrentCUDAStream(dev.index()));
+      ev->block(*stream);
       at::cuda::CUDAStreamGuard guard(*stream);
       preproc();
-      comm->enqueue_cuda_collective(std::move(data), work, coll, team, cuda_ee);
+      if (captured) {
+        // replays run the TL kernels recorded by the triggered post, host
+        // timings of the capture are meaningless
+        work->metrics_ = nullptr;
+        std::shared_ptr<ProgressEntry> entry;
+        comm->enqueue_cuda_collective(
+            std::move(data),
+            work,
+            coll,
+            team,
+            cuda_ee,
+            std::move(persistent),
+            &entry);
+        std::lock_guard<std::mutex> lock(capture_mutex);
+        captured_entries.push_back(std::move(entry));
+        has_captured = true;
+      } else if (hier) {
+        enqueue_hier_allreduce(std::move(data), work, coll, inputTensors[0]);
+      } else if (chunks > 1) {
+        enqueue_chunked_collective(
+            std::move(data), work, coll, inputTensors[0].element_size(), chunks);
+      } else {
+        comm->enqueue_cuda_collective(
+            std::move(data), work, coll, team, cuda_ee, std::move(persistent));
+      }
       postproc();
-      cuda_ev->record(*stream);
-      work->fence = std::move(cuda_ev);
-      work->ep = &ep;
-      if (torch_ucc_config.use_future) {
+      ev->record(*stream);
+      if (captured) {
+        cudaStreamCaptureStatus status;
+        C10_CUDA_CHECK(cudaStreamGetCaptureInfo(
+            at::cuda::getCurrentCUDAStream(dev.index()).stream(),
+            &status,
+            &work->capture_id));
+        work->capture_fence = std::move(cuda_ev);
+      } else {
+        work->fence = std::move(cuda_ev);
+        work->ep = &ep;
+        work->host_completion = host_completion;
+      }
+      if (torch_ucc_config.use_future && !host_completion) {
         c10::cuda::CUDAMultiStreamGuard streamGuard(*stream);
         std::vector<c10::Device> devList{dev};
         work->future_ = c10::make_intrusive<at::ivalue::Future>(
@@ -990,6 +2872,480 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::collective_post(
   }
 }
 
+std::vector<int> ProcessGroupUCC::node_layout() {
+  std::vector<int> node_of(size_);
+  if (torch_ucc_config.hier_local_size > 0) {
+    for (int r = 0; r < size_; r++) {
+      node_of[r] = r / torch_ucc_config.hier_local_size;
+    }
+    return node_of;
+  }
+  constexpr size_t kHostLen = 256;
+  char host[kHostLen] = {0};
+  gethostname(host, kHostLen - 1);
+  std::vector<char> hosts(kHostLen * size_);
+  oob_allgather_sync(oob.get(), host, hosts.data(), kHostLen);
+  std::unordered_map<std::string, int> nodes;
+  for (int r = 0; r < size_; r++) {
+    node_of[r] =
+        nodes.emplace(std::string(&hosts[r * kHostLen]), (int)nodes.size())
+            .first->second;
+  }
+  return node_of;
+}
+
+std::string ProcessGroupUCC::tune_key(c10::Device dev) {
+  const std::vector<int> node_of = node_layout();
+  std::vector<int> node_sizes(
+      *std::max_element(node_of.begin(), node_of.end()) + 1, 0);
+  for (int node : node_of) {
+    node_sizes[node]++;
+  }
+  const bool uniform = std::all_of(
+      node_sizes.begin(), node_sizes.end(), [&](int n) {
+        return n == node_sizes[0];
+      });
+  // nodes of different size are keyed as 0 ranks per node
+  return c10::str(
+      "ws",
+      size_,
+      "_nodes",
+      node_sizes.size(),
+      "x",
+      uniform ? node_sizes[0] : 0,
+      "_",
+      dev.is_cuda() ? "cuda" : "cpu");
+}
+
+void ProcessGroupUCC::autotune(c10::Device dev) {
+  if (!tune_table.start(dev.type())) {
+    return;
+  }
+  const std::string key = tune_key(dev);
+  ProcessGroupUCCTuneTable::Rows rows;
+  for (auto& row : rows) {
+    row.fill(-1);
+  }
+  // only rank 0 reads the file so all ranks take the same paths even if
+  // their copies differ
+  std::vector<int8_t> local(1 + sizeof(rows), 0);
+  if (rank_ == 0 && !torch_ucc_config.tune_file.empty()) {
+    try {
+      local[0] =
+          ProcessGroupUCCTuneTable::load(torch_ucc_config.tune_file, key, rows);
+    } catch (const std::exception& e) {
+      TORCH_UCC_LOG_ERROR(TORCH_UCC_INIT, e.what());
+    }
+    std::memcpy(local.data() + 1, rows.data(), sizeof(rows));
+  }
+  std::vector<int8_t> all(local.size() * size_);
+  oob_allgather_sync(oob.get(), local.data(), all.data(), local.size());
+  if (all[0]) {
+    std::memcpy(rows.data(), all.data() + 1, sizeof(rows));
+    tune_table.set_rows(dev.type(), rows);
+    TORCH_UCC_LOG_INFO(
+        TORCH_UCC_INIT,
+        c10::str(
+            "loaded tuning table ", key, " from ", torch_ucc_config.tune_file));
+    return;
+  }
+  if (torch_ucc_config.tune) {
+    tune(dev);
+  }
+}
+
+void ProcessGroupUCC::tune(c10::Device dev) {
+  initComm(dev);
+  // collectives of the benchmark must not start another tuning
+  tune_table.start(dev.type());
+  const std::string key = tune_key(dev);
+  TORCH_UCC_LOG_INFO(TORCH_UCC_INIT, c10::str("tuning ", key));
+  const auto rows = benchmark_candidates(dev);
+  tune_table.set_rows(dev.type(), rows);
+  if (rank_ == 0 && !torch_ucc_config.tune_file.empty()) {
+    try {
+      ProcessGroupUCCTuneTable::save(torch_ucc_config.tune_file, key, rows);
+    } catch (const std::exception& e) {
+      TORCH_UCC_LOG_ERROR(TORCH_UCC_INIT, e.what());
+    }
+  }
+}
+
+ProcessGroupUCCTuneTable::Rows ProcessGroupUCC::benchmark_candidates(
+    c10::Device dev) {
+  constexpr int kWarmup = 3;
+  constexpr int kIters = 10;
+  std::vector<int64_t> sizes;
+  for (int64_t size = 1024; size <= torch_ucc_config.tune_max_size;
+       size *= 4) {
+    sizes.push_back(size);
+  }
+  // tuned operation and benchmark operation measuring it
+  std::vector<std::pair<torch_ucc_tune_op_t, std::string>> ops;
+  if (dev.is_cuda()) {
+    // CPU allgather always goes through allgatherv
+    ops.emplace_back(TORCH_UCC_TUNE_ALLGATHER, "allgather");
+  }
+  if (dev.is_cuda() ? torch_ucc_config.chunk_size > 0
+                    : (torch_ucc_config.cpu_helpers > 0 &&
+                       torch_ucc_config.cpu_shard_size > 0)) {
+    ops.emplace_back(TORCH_UCC_TUNE_CHUNKING, "allreduce");
+  }
+#ifdef USE_CUDA
+  if (dev.is_cuda()) {
+    init_hier_teams();
+    if (hier.enabled) {
+      ops.emplace_back(TORCH_UCC_TUNE_HIER, "allreduce");
+    }
+  }
+#endif
+
+  ProcessGroupUCCTuneTable::Rows rows;
+  for (auto& row : rows) {
+    row.fill(-1);
+  }
+  if (sizes.empty()) {
+    return rows;
+  }
+  // benchmark buffers are thrown away, they must not take persistent cache
+  // entries of the application
+  const bool persistent = persistent_enabled;
+  for (const auto& op : ops) {
+    // mean latency of choice c at sizes[i] is means[2 * i + c]
+    std::vector<double> means(sizes.size() * 2, 0.0);
+    persistent_enabled = false;
+    try {
+      for (size_t i = 0; i < sizes.size(); i++) {
+        for (int c = 0; c < 2; c++) {
+          tune_table.force(op.first, c);
+          const auto times =
+              runBenchmark(*this, op.second, sizes[i], dev, kWarmup, kIters);
+          for (double t : times) {
+            means[2 * i + c] += t / times.size();
+          }
+        }
+      }
+    } catch (...) {
+      tune_table.unforce();
+      persistent_enabled = persistent;
+      throw;
+    }
+    tune_table.unforce();
+    persistent_enabled = persistent;
+    // slowest rank decides, all ranks end up with the same winners
+    std::vector<double> all(means.size() * size_);
+    oob_allgather_sync(
+        oob.get(), means.data(), all.data(), means.size() * sizeof(double));
+    for (int r = 0; r < size_; r++) {
+      for (size_t j = 0; j < means.size(); j++) {
+        means[j] = std::max(means[j], all[r * means.size() + j]);
+      }
+    }
+    // unmeasured buckets take the winner of the closest measured size
+    for (int b = 0; b < ProcessGroupUCCTuneTable::kBuckets; b++) {
+      size_t closest = 0;
+      for (size_t i = 1; i < sizes.size(); i++) {
+        if (std::abs(ProcessGroupUCCTuneTable::size_bucket(sizes[i]) - b) <
+            std::abs(
+                ProcessGroupUCCTuneTable::size_bucket(sizes[closest]) - b)) {
+          closest = i;
+        }
+      }
+      rows[op.first][b] = means[2 * closest + 1] < means[2 * closest] ? 1 : 0;
+    }
+    for (size_t i = 0; i < sizes.size(); i++) {
+      TORCH_UCC_LOG_INFO(
+          TORCH_UCC_INIT,
+          c10::str(
+              "tuned ",
+              torch_ucc_tune_op_name(op.first),
+              " ",
+              sizes[i],
+              " bytes: ",
+              means[2 * i],
+              " us vs ",
+              means[2 * i + 1],
+              " us"));
+    }
+  }
+  return rows;
+}
+
+#ifdef USE_CUDA
+void ProcessGroupUCC::enqueue_chunked_collective(
+    std::unique_ptr<WorkData> data,
+    c10::intrusive_ptr<WorkUCC> work,
+    ucc_coll_args_t& coll,
+    size_t element_size,
+    size_t chunks) {
+  auto& info = coll_chunked_info(coll);
+  const uint64_t count = info.count;
+  const uint64_t chunk_count = split_piece_count(count, chunks);
+  work->chunks_.reserve(chunks);
+  for (size_t i = 0; i < chunks; i++) {
+    const uint64_t offset = i * chunk_count;
+    TORCH_INTERNAL_ASSERT(offset < count || i == 0);
+    ucc_coll_args_t chunk_coll = coll_chunk_args(
+        coll, offset, std::min(chunk_count, count - offset), element_size);
+    auto chunk_work = c10::make_intrusive<WorkUCC>(
+        work->retrieveOpType(), nullptr, logger);
+    if (work->metrics_) {
+      chunk_work->metrics_ = work->metrics_;
+      chunk_work->sample_ = work->sample_;
+      chunk_work->sample_.bytes =
+          coll_chunked_info(chunk_coll).count * element_size;
+    }
+    // tensors are kept by the last chunk, it completes after the others
+    // have been posted
+    comm->enqueue_cuda_collective(
+        i == chunks - 1 ? std::move(data) : nullptr,
+        chunk_work,
+        chunk_coll,
+        team,
+        cuda_ee,
+        persistent_enabled ? get_persistent_collective(chunk_coll) : nullptr);
+    auto chunk_ev = getPooledEvent();
+    chunk_ev->record(*stream);
+    chunk_work->fence = std::move(chunk_ev);
+    chunk_work->ep = &ep;
+    work->chunks_.push_back(std::move(chunk_work));
+  }
+}
+
+void ProcessGroupUCC::init_hier_teams() {
+  std::call_once(hier_flag, [this]() {
+    const std::vector<int> node_of = node_layout();
+    std::vector<int> node_sizes;
+    int local_rank = 0;
+    for (int r = 0; r < size_; r++) {
+      if (node_of[r] >= (int)node_sizes.size()) {
+        node_sizes.resize(node_of[r] + 1, 0);
+      }
+      if (r == rank_) {
+        local_rank = node_sizes[node_of[r]];
+      }
+      node_sizes[node_of[r]]++;
+    }
+    const bool uniform = std::all_of(
+        node_sizes.begin(), node_sizes.end(), [&](int n) {
+          return n == node_sizes[0];
+        });
+    if (node_sizes.size() < 2 || node_sizes[0] < 2 || !uniform) {
+      TORCH_UCC_LOG_INFO(
+          TORCH_UCC_INIT,
+          c10::str(
+              "hierarchical allreduce disabled, ",
+              node_sizes.size(),
+              " nodes",
+              uniform ? "" : " with different number of ranks"));
+      return;
+    }
+    hier.node = node_of[rank_];
+    hier.num_nodes = node_sizes.size();
+    hier.local_rank = local_rank;
+    hier.local_size = node_sizes[0];
+    hier.intra_oob = std::make_shared<torch_ucc_oob_coll_info_t>();
+    hier.intra_oob->rank = hier.local_rank;
+    hier.intra_oob->size = hier.local_size;
+    hier.intra_oob->store = oob->store;
+    hier.intra_oob->comm_id = oob->comm_id;
+    hier.intra_oob->key_prefix = c10::str("hier_intra", hier.node, "/");
+    hier.inter_oob = std::make_shared<torch_ucc_oob_coll_info_t>();
+    hier.inter_oob->rank = hier.node;
+    hier.inter_oob->size = hier.num_nodes;
+    hier.inter_oob->store = oob->store;
+    hier.inter_oob->comm_id = oob->comm_id;
+    hier.inter_oob->key_prefix = c10::str("hier_inter", hier.local_rank, "/");
+    comm->ucc_create_team(hier.intra, hier.intra_oob);
+    comm->ucc_create_team(hier.inter, hier.inter_oob);
+    hier.enabled = true;
+    TORCH_UCC_LOG_INFO(
+        TORCH_UCC_INIT,
+        c10::str(
+            "created hierarchical teams, ",
+            hier.num_nodes,
+            " nodes of ",
+            hier.local_size,
+            " ranks"));
+  });
+}
+
+bool ProcessGroupUCC::use_hier_allreduce(
+    const ucc_coll_args_t& coll,
+    const std::vector<at::Tensor>& tensors) {
+  if (coll.coll_type != UCC_COLL_TYPE_ALLREDUCE || tensors.empty()) {
+    return false;
+  }
+  const size_t nbytes = tensors_nbytes(tensors);
+  const int tuned =
+      tune_table.choice(TORCH_UCC_TUNE_HIER, c10::DeviceType::CUDA, nbytes);
+  if (tuned == 0 ||
+      (tuned < 0 &&
+       (torch_ucc_config.hier_allreduce_threshold <= 0 ||
+        nbytes < (size_t)torch_ucc_config.hier_allreduce_threshold))) {
+    return false;
+  }
+#ifdef USE_ACTIVE_SETS
+  if (coll.mask & UCC_COLL_ARGS_FIELD_ACTIVE_SET) {
+    return false;
+  }
+#endif
+  // same message size on all ranks, so all of them get here
+  init_hier_teams();
+  return hier.enabled;
+}
+
+void ProcessGroupUCC::enqueue_hier_allreduce(
+    std::unique_ptr<WorkData> data,
+    c10::intrusive_ptr<WorkUCC> work,
+    ucc_coll_args_t& coll,
+    const at::Tensor& like) {
+  const uint64_t count = coll.dst.info.count;
+  const uint64_t block = (count + hier.local_size - 1) / hier.local_size;
+  const bool padded = block * hier.local_size != count;
+  // reduced block, followed by padded copy of the buffer if its size is not
+  // a multiple of local size. Separate from the buffer of compressed
+  // allreduce, which may be the one reduced here.
+  auto staging = get_staging_buffer(
+      like, block + (padded ? block * hier.local_size : 0), "hier");
+  at::Tensor reduced = staging->buffer.narrow(0, 0, block);
+  at::Tensor full = like.view({-1});
+  if (padded) {
+    full = staging->buffer.narrow(0, block, block * hier.local_size);
+    full.narrow(0, 0, count).copy_(like.view({-1}), true);
+  }
+
+  ucc_coll_args_t phases[3] = {coll, coll, coll};
+  ucc_coll_args_t& rs = phases[0];
+  rs.coll_type = UCC_COLL_TYPE_REDUCE_SCATTER;
+  rs.flags &= ~UCC_COLL_ARGS_FLAG_IN_PLACE;
+  rs.src.info = coll.dst.info;
+  rs.src.info.buffer = full.data_ptr();
+  rs.src.info.count = block * hier.local_size;
+  rs.dst.info = coll.dst.info;
+  rs.dst.info.buffer = reduced.data_ptr();
+  rs.dst.info.count = block;
+  ucc_coll_args_t& ar = phases[1];
+  ar.src.info.count = block;
+  ar.dst.info = rs.dst.info;
+  ucc_coll_args_t& ag = phases[2];
+  ag.coll_type = UCC_COLL_TYPE_ALLGATHER;
+  ag.flags &= ~UCC_COLL_ARGS_FLAG_IN_PLACE;
+  ag.src.info = rs.dst.info;
+  ag.dst.info = rs.src.info;
+  ucc_team_h teams[3] = {hier.intra, hier.inter, hier.intra};
+
+  work->chunks_.reserve(3);
+  for (size_t i = 0; i < 3; i++) {
+    auto phase_work = c10::make_intrusive<WorkUCC>(
+        work->retrieveOpType(), nullptr, logger);
+    if (work->metrics_) {
+      phase_work->metrics_ = work->metrics_;
+      phase_work->sample_ = work->sample_;
+      phase_work->sample_.bytes =
+          phases[i].dst.info.count * like.element_size();
+    }
+    // tensors are kept by the last phase, staging buffer is ordered by the
+    // internal stream
+    comm->enqueue_cuda_collective(
+        i == 2 ? std::move(data) : nullptr,
+        phase_work,
+        phases[i],
+        teams[i],
+        cuda_ee);
+    if (i == 2 && padded) {
+      like.view({-1}).copy_(full.narrow(0, 0, count), true);
+    }
+    auto phase_ev = getPooledEvent();
+    phase_ev->record(*stream);
+    phase_work->fence = std::move(phase_ev);
+    phase_work->ep = &ep;
+    work->chunks_.push_back(std::move(phase_work));
+  }
+}
+#endif
+
+void ProcessGroupUCC::ShardWorkData::complete(bool success) {
+  if (!success) {
+    shared->success = false;
+  }
+  if (--shared->pending > 0) {
+    return;
+  }
+  const bool all_success = shared->success;
+  if (shared->data) {
+    shared->data->complete(all_success);
+  }
+  if (shared->future) {
+    if (all_success) {
+      shared->future->markCompleted(c10::IValue(
+          shared->data ? shared->data->dst : std::vector<at::Tensor>()));
+    } else {
+      shared->future->setError(std::make_exception_ptr(
+          std::runtime_error("sharded CPU collective failed")));
+    }
+  }
+}
+
+void ProcessGroupUCC::init_cpu_helpers() {
+  std::call_once(cpu_helpers_flag, [this]() {
+    std::vector<cpu_helper_t> helpers(torch_ucc_config.cpu_helpers);
+    for (size_t i = 0; i < helpers.size(); i++) {
+      auto& helper = helpers[i];
+      helper.oob = std::make_shared<torch_ucc_oob_coll_info_t>();
+      helper.oob->rank = oob->rank;
+      helper.oob->size = oob->size;
+      helper.oob->store = oob->store;
+      helper.oob->comm_id = oob->comm_id;
+      helper.oob->key_prefix = c10::str("cpu_helper", i, "/");
+      helper.comm = std::make_shared<CommPG>(
+          logger, helper.oob, c10::Device(c10::kCPU), false, (int)i + 1);
+      helper.comm->ucc_create_team(helper.team, helper.oob);
+    }
+    cpu_helpers = std::move(helpers);
+    TORCH_UCC_LOG_INFO(
+        TORCH_UCC_INIT,
+        c10::str("created ", cpu_helpers.size(), " CPU helper communicators"));
+  });
+}
+
+void ProcessGroupUCC::enqueue_sharded_collective(
+    std::unique_ptr<WorkData> data,
+    c10::intrusive_ptr<WorkUCC> work,
+    ucc_coll_args_t& coll,
+    size_t element_size,
+    size_t shards) {
+  init_cpu_helpers();
+  const uint64_t count = coll_chunked_info(coll).count;
+  const uint64_t shard_count = split_piece_count(count, shards);
+  auto shared = std::make_shared<ShardWorkData::Shared>();
+  shared->data = std::move(data);
+  shared->future = work->getFuture();
+  shared->pending = shards;
+  work->chunks_.reserve(shards);
+  for (size_t i = 0; i < shards; i++) {
+    const uint64_t offset = i * shard_count;
+    TORCH_INTERNAL_ASSERT(offset < count || i == 0);
+    ucc_coll_args_t shard_coll = coll_chunk_args(
+        coll, offset, std::min(shard_count, count - offset), element_size);
+    auto shard_work = c10::make_intrusive<WorkUCC>(
+        work->retrieveOpType(), nullptr, logger);
+    if (work->metrics_) {
+      shard_work->metrics_ = work->metrics_;
+      shard_work->sample_ = work->sample_;
+      shard_work->sample_.bytes =
+          coll_chunked_info(shard_coll).count * element_size;
+    }
+    auto* shard_comm = i == 0 ? comm.get() : cpu_helpers[i - 1].comm.get();
+    shard_comm->enqueue_collective(
+        std::make_unique<ShardWorkData>(shared),
+        shard_work,
+        shard_coll,
+        i == 0 ? team : cpu_helpers[i - 1].team);
+    work->chunks_.push_back(std::move(shard_work));
+  }
+}
+
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allgather(
     std::vector<std::vector<at::Tensor>>& outputTensors,
     std::vector<at::Tensor>& inputTensors,
@@ -998,7 +3354,12 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allgather(
   check_device(tensor.device(), outputTensors[0][0].device());
   initComm(tensor.device());
 
-  if (tensor.device().is_cpu() || torch_ucc_config.use_allgatherv) {
+  const int tuned = tune_table.choice(
+      TORCH_UCC_TUNE_ALLGATHER,
+      tensor.device().type(),
+      tensor.element_size() * tensor.numel() * size_);
+  if (tensor.device().is_cpu() ||
+      (tuned < 0 ? torch_ucc_config.use_allgatherv : tuned == 1)) {
     AllgathervWorkData* data = new AllgathervWorkData(size_);
     for (int i = 0; i < size_; i++) {
       data->recv_lengths[i] = tensor.element_size() * tensor.numel();
@@ -1033,14 +3394,12 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allgather(
         outputTensors[0],
         "ucc:allgatherv");
   } else {
-    WorkData* data = new WorkData();
-    std::vector<at::Tensor> flat_output(outputTensors.size());
-    for (size_t i = 0; i < outputTensors.size(); i++) {
-      TORCH_CHECK(outputTensors[i].size() == outputTensors.size() * size_,
-        "Tensor output list is not valid for the number of participants");
-        flat_output[i] = c10d::newLikeFlat(outputTensors, i);
-    }
-    SAVE_TENSORS(flat_output, data->flat);
+    auto data = std::make_unique<StagingWorkData>();
+    auto& outputs = outputTensors[0];
+    TORCH_CHECK(outputs.size() == (size_t)size_,
+      "Tensor output list is not valid for the number of participants");
+    SAVE_TENSORS(inputTensors, data->src);
+    SAVE_TENSORS(outputs, data->dst);
     ucc_coll_args_t coll;
     coll.mask = 0;
     coll.flags = 0;
@@ -1049,32 +3408,52 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allgather(
     coll.src.info.count = tensor.numel();
     coll.src.info.datatype = to_ucc_dType(tensor);
     coll.src.info.mem_type = to_ucc_memType(tensor.device().type());
-    coll.dst.info.buffer = flat_output[0].data_ptr();
-    coll.dst.info.count = flat_output[0].numel();
-    coll.dst.info.datatype = to_ucc_dType(flat_output[0]);
-    coll.dst.info.mem_type =
-        to_ucc_memType(outputTensors[0][0].device().type());
+    coll.dst.info.count = tensor.numel() * size_;
+    coll.dst.info.datatype = to_ucc_dType(tensor);
+    coll.dst.info.mem_type = to_ucc_memType(outputs[0].device().type());
+
+    if (is_flat_view(outputs, tensor)) {
+      // outputs are chunks of one buffer, gather into them directly
+      coll.dst.info.buffer = outputs[0].data_ptr();
+      return collective_post(
+          OpType::ALLGATHER,
+          []() {},
+          []() {},
+          coll,
+          std::move(data),
+          tensor.device(),
+          inputTensors,
+          outputs,
+          "ucc:allgather");
+    }
+
+    data->staging = get_staging_buffer(tensor, tensor.numel() * size_);
+    std::vector<int64_t> flat_sizes{size_};
+    flat_sizes.insert(
+        flat_sizes.end(), tensor.sizes().begin(), tensor.sizes().end());
+    at::Tensor flat_output = data->staging->buffer.narrow(
+        0, 0, tensor.numel() * size_).view(flat_sizes);
+    data->flat = {flat_output};
+    coll.dst.info.buffer = flat_output.data_ptr();
 
-    auto copy_from_flat = [&] {
+    auto copy_from_flat = [&, flat_output] {
       bool asyncCopy = false;
   #ifdef USE_CUDA
-      bool isCuda = outputTensors[0][0].device().is_cuda();;
+      bool isCuda = outputs[0].device().is_cuda();
   #endif
-      for (size_t i = 0; i < outputTensors.size(); i++) {
-        auto inumel = inputTensors[i].numel();
-        for (size_t j = 0; j < outputTensors[i].size(); j++) {
-          TORCH_CHECK(
-            (outputTensors[i][j].numel() == inumel),
-            "Tensor operand counts must be same");
+      auto inumel = tensor.numel();
+      for (size_t j = 0; j < outputs.size(); j++) {
+        TORCH_CHECK(
+          (outputs[j].numel() == inumel),
+          "Tensor operand counts must be same");
   #ifdef USE_CUDA
-          if (isCuda) {
-            c10::cuda::CUDACachingAllocator::recordStream(
-              outputTensors[i][j].storage().data_ptr(), (*stream));
-            asyncCopy = true;
-          }
-  #endif
-          outputTensors[i][j].copy_(flat_output[i][j], asyncCopy);
+        if (isCuda) {
+          c10::cuda::CUDACachingAllocator::recordStream(
+            outputs[j].storage().data_ptr(), (*stream));
+          asyncCopy = true;
         }
+  #endif
+        outputs[j].copy_(flat_output[j], asyncCopy);
       }
     };
     return collective_post(
@@ -1082,10 +3461,10 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allgather(
         []() {},
         copy_from_flat,
         coll,
-        std::unique_ptr<WorkData>(data),
+        std::move(data),
         tensor.device(),
         inputTensors,
-        outputTensors[0],
+        outputs,
         "ucc:allgather");
   }
 }
@@ -1133,9 +3512,21 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::_allgather_base(
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allreduce(
     std::vector<at::Tensor>& tensors,
     const AllreduceOptions& opts) {
+  if (tensors.size() == 1 && tensors[0].is_sparse()) {
+    initComm(tensors[0].device());
+    takeCompressionBucket();
+    return allreduce_sparse(tensors, opts);
+  }
   check_tensor(tensors);
   auto& tensor = tensors[0];
   initComm(tensor.device());
+#ifdef USE_CUDA
+  if (use_compression(tensor, opts.reduceOp)) {
+    return allreduce_compressed(tensors, opts);
+  }
+#endif
+  // the bucket only applies to this reduction
+  takeCompressionBucket();
   WorkData* data = new WorkData();
 
   ucc_coll_args_t coll;
@@ -1164,11 +3555,495 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allreduce(
       "ucc:allreduce");
 }
 
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allreduce_sparse(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  TORCH_CHECK(
+      opts.reduceOp == ReduceOp::SUM, "sparse allreduce only supports SUM");
+  // the count exchange is waited on here, inside a group it never starts
+  TORCH_CHECK(
+      torch_ucc_group.depth == 0,
+      "sparse allreduce can't be issued between group_start and group_end");
+  auto& tensor = tensors[0];
+#ifdef USE_CUDA
+  // sizes of the exchange and of the result depend on the data
+  TORCH_CHECK(
+      !tensor.device().is_cuda() || !is_capturing(tensor.device()),
+      "sparse allreduce can't be captured in a CUDA graph");
+#endif
+  const auto input = tensor.coalesce();
+  const int64_t sparse_dim = input.sparse_dim();
+  const int64_t dense_dim = input.dense_dim();
+  at::Tensor indices = input._indices().contiguous();
+  at::Tensor values = input._values().contiguous();
+
+  // entry counts of all ranks are needed to post the exchange
+  std::vector<int64_t> local{input._nnz(), sparse_dim, dense_dim};
+  at::Tensor meta = at::tensor(local, at::TensorOptions().dtype(at::kLong));
+  at::Tensor metas = at::empty({size_, 3}, at::kLong);
+  AllgatherOptions meta_opts;
+  _allgather_base(metas, meta, meta_opts)->wait();
+  auto m = metas.accessor<int64_t, 2>();
+
+  int64_t dense_numel = 1;
+  for (int64_t d = sparse_dim; d < tensor.dim(); d++) {
+    dense_numel *= tensor.size(d);
+  }
+  const int64_t index_bytes = sparse_dim * sizeof(int64_t);
+  const int64_t value_bytes = dense_numel * values.element_size();
+  auto data = new SparseAllreduceWorkData(size_);
+  std::vector<int64_t> nnz(size_);
+  uint64_t total = 0;
+  for (int r = 0; r < size_; r++) {
+    TORCH_CHECK(
+        m[r][1] == sparse_dim && m[r][2] == dense_dim,
+        "sparse allreduce tensors must have the same layout on all ranks");
+    nnz[r] = m[r][0];
+    data->recv_lengths[r] = nnz[r] * (index_bytes + value_bytes);
+    data->recv_offsets[r] = total;
+    // values of the next rank start aligned for int64 indices
+    total += (data->recv_lengths[r] + sizeof(int64_t) - 1) /
+        sizeof(int64_t) * sizeof(int64_t);
+  }
+
+  // indices followed by values, both as bytes
+  at::Tensor send = at::cat(
+      {indices.view({-1}).view(at::kByte), values.view({-1}).view(at::kByte)});
+  at::Tensor recv = at::empty(
+      {(int64_t)std::max<uint64_t>(total, 1)},
+      at::TensorOptions().dtype(at::kByte).device(tensor.device()));
+
+  ucc_coll_args_t coll;
+  coll.mask = UCC_COLL_ARGS_FIELD_FLAGS;
+  coll.flags =
+      UCC_COLL_ARGS_FLAG_COUNT_64BIT | UCC_COLL_ARGS_FLAG_DISPLACEMENTS_64BIT;
+  coll.coll_type = UCC_COLL_TYPE_ALLGATHERV;
+  coll.src.info.buffer = send.data_ptr();
+  coll.src.info.count = send.numel();
+  coll.src.info.datatype = UCC_DT_UINT8;
+  coll.src.info.mem_type = to_ucc_memType(tensor.device().type());
+  coll.dst.info_v.buffer = recv.data_ptr();
+  coll.dst.info_v.counts = (ucc_count_t*)data->recv_lengths.data();
+  coll.dst.info_v.displacements = (ucc_aint_t*)data->recv_offsets.data();
+  coll.dst.info_v.datatype = UCC_DT_UINT8;
+  coll.dst.info_v.mem_type = to_ucc_memType(tensor.device().type());
+  std::vector<at::Tensor> sends{send};
+  std::vector<at::Tensor> recvs{recv};
+  SAVE_TENSORS(sends, data->src);
+  SAVE_TENSORS(recvs, data->flat);
+  SAVE_TENSORS(tensors, data->dst);
+
+  std::vector<uint64_t> offsets(
+      data->recv_offsets.begin(), data->recv_offsets.end());
+  // captures by value, executes on the progress thread once the exchange
+  // is done so the posting thread doesn't wait for coalesce
+  auto merge = [tensor, recv, indices, values, nnz, offsets, index_bytes,
+                value_bytes]() mutable {
+#ifdef USE_CUDA
+    c10::optional<at::cuda::CUDAStreamGuard> stream_guard;
+    if (tensor.device().is_cuda()) {
+      // completed request means the allgatherv finished on the device, the
+      // internal stream may already hold later collectives
+      stream_guard.emplace(
+          at::cuda::getStreamFromPool(false, tensor.device().index()));
+    }
+#endif
+    // start from empty local slices so the result keeps dtypes and shape
+    std::vector<at::Tensor> all_indices{indices.narrow(1, 0, 0)};
+    std::vector<at::Tensor> all_values{values.narrow(0, 0, 0)};
+    auto value_sizes = values.sizes().vec();
+    for (size_t r = 0; r < nnz.size(); r++) {
+      if (nnz[r] == 0) {
+        continue;
+      }
+      at::Tensor seg = recv.narrow(
+          0, offsets[r], nnz[r] * (index_bytes + value_bytes));
+      value_sizes[0] = nnz[r];
+      all_indices.push_back(seg.narrow(0, 0, nnz[r] * index_bytes)
+                                .view(at::kLong)
+                                .view({indices.size(0), nnz[r]}));
+      all_values.push_back(
+          seg.narrow(0, nnz[r] * index_bytes, nnz[r] * value_bytes)
+              .view(values.scalar_type())
+              .view(value_sizes));
+    }
+    // coalesce sorts the entries and sums duplicates on the device
+    tensor.copy_(at::sparse_coo_tensor(
+                     at::cat(all_indices, 1),
+                     at::cat(all_values, 0),
+                     tensor.sizes())
+                     .coalesce());
+#ifdef USE_CUDA
+    if (stream_guard) {
+      // result is complete when the work is
+      stream_guard->current_stream().synchronize();
+    }
+#endif
+  };
+  data->merge = std::move(merge);
+  data->host_completion = true;
+  return collective_post(
+      OpType::ALLREDUCE,
+      [this, recv, send]() {
+#ifdef USE_CUDA
+        if (recv.is_cuda()) {
+          c10::cuda::CUDACachingAllocator::recordStream(
+              recv.storage().data_ptr(), (*stream));
+          c10::cuda::CUDACachingAllocator::recordStream(
+              send.storage().data_ptr(), (*stream));
+        }
+#endif
+      },
+      []() {},
+      coll,
+      std::unique_ptr<WorkData>(data),
+      tensor.device(),
+      sends,
+      tensors,
+      "ucc:allreduce_sparse");
+}
+
+std::shared_ptr<ProcessGroupUCC::StagingBuffer> ProcessGroupUCC::
+    get_staging_buffer(
+        const at::Tensor& like,
+        int64_t numel,
+        const std::string& purpose) {
+  auto options = at::TensorOptions()
+                     .dtype(like.scalar_type())
+                     .device(like.device());
+  std::string stream_key = c10::str(like.device());
+#ifdef USE_CUDA
+  if (like.device().is_cuda()) {
+    stream_key += c10::str(":", stream->id());
+  }
+#endif
+  auto allocate = [&](int64_t n, const at::TensorOptions& opts) {
+#ifdef USE_CUDA
+    // allocate on internal stream so the old buffer is freed in stream order
+    c10::optional<at::cuda::CUDAStreamGuard> guard;
+    if (like.device().is_cuda()) {
+      guard.emplace(*stream);
+    }
+#endif
+    return at::empty({n}, opts);
+  };
+  if (buffer_pool) {
+    auto staging = std::make_shared<StagingBuffer>();
+    staging->in_use = true;
+    staging->raw = buffer_pool->acquire(
+        stream_key,
+        std::max<int64_t>(numel, 1) * like.element_size(),
+        [&](int64_t nbytes) {
+          return allocate(nbytes, options.dtype(at::kByte));
+        });
+    staging->buffer = staging->raw.view(like.scalar_type());
+    staging->pool = buffer_pool;
+    staging->pool_key = stream_key;
+    return staging;
+  }
+  std::string key =
+      c10::str(purpose, ":", like.scalar_type(), ":", stream_key);
+  std::lock_guard<std::mutex> lock(staging_mutex);
+  auto& cached = staging_buffers[key];
+  if (!cached) {
+    cached = std::make_shared<StagingBuffer>();
+  }
+  std::shared_ptr<StagingBuffer> staging = cached;
+  bool expected = false;
+  if (!like.device().is_cuda() &&
+      !staging->in_use.compare_exchange_strong(expected, true)) {
+    // previous CPU collective still owns cached buffer
+    staging = std::make_shared<StagingBuffer>();
+    staging->in_use = true;
+  }
+  // cached CUDA buffer is shared by threads posting on the stream, it is
+  // only resized under the lock
+  if (!staging->buffer.defined() || staging->buffer.numel() < numel) {
+    staging->buffer = allocate(numel, options);
+  }
+  if (like.device().is_cuda()) {
+    // caller keeps the tensor it got even if another thread grows the
+    // cached one later
+    auto snapshot = std::make_shared<StagingBuffer>();
+    snapshot->buffer = staging->buffer;
+    snapshot->in_use = true;
+    return snapshot;
+  }
+  return staging;
+}
+
+at::Tensor ProcessGroupUCC::BufferPool::acquire(
+    const std::string& key,
+    int64_t nbytes,
+    const std::function<at::Tensor(int64_t)>& alloc) {
+  // smallest class holds any dtype, also aligns views of larger ones
+  int64_t class_bytes = kMinPooledBytes;
+  while (class_bytes < nbytes) {
+    class_bytes *= 2;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = free_.find(c10::str(key, ":", class_bytes));
+    if (it != free_.end() && !it->second.empty()) {
+      at::Tensor buffer = std::move(it->second.back());
+      it->second.pop_back();
+      cached_bytes_ -= class_bytes;
+      return buffer;
+    }
+  }
+  try {
+    return alloc(class_bytes);
+  } catch (const c10::Error&) {
+    // free buffers of other sizes are invisible to the allocator, give them
+    // back before failing
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_.clear();
+      cached_bytes_ = 0;
+    }
+    return alloc(class_bytes);
+  }
+}
+
+void ProcessGroupUCC::BufferPool::release(
+    const std::string& key,
+    at::Tensor buffer) {
+  if (!buffer.defined()) {
+    return;
+  }
+  const int64_t class_bytes = buffer.numel();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cached_bytes_ + class_bytes > capacity_) {
+    // freed when buffer goes out of scope
+    return;
+  }
+  free_[c10::str(key, ":", class_bytes)].push_back(std::move(buffer));
+  cached_bytes_ += class_bytes;
+}
+
+int64_t ProcessGroupUCC::BufferPool::cachedBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cached_bytes_;
+}
+
+#ifdef USE_CUDA
+at::Tensor ProcessGroupUCC::get_compression_residual(
+    const at::Tensor& buffer,
+    int64_t bucket,
+    int64_t numel) {
+  if (!torch_ucc_config.compression_error_feedback || bucket < 0) {
+    return at::Tensor();
+  }
+  // numel tells rebuilt buckets of the same index apart
+  std::string key = c10::str(buffer.device(), ":", bucket, ":", numel);
+  std::lock_guard<std::mutex> lock(compression_mutex);
+  auto it = compression_residuals.find(key);
+  if (it != compression_residuals.end()) {
+    return it->second;
+  }
+  if (compression_residuals.size() >= kMaxCompressionResiduals) {
+    compression_residuals.clear();
+  }
+  at::cuda::CUDAStreamGuard guard(*stream);
+  at::Tensor residual = at::zeros({numel}, buffer.options());
+  compression_residuals.emplace(key, residual);
+  return residual;
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allreduce_compressed(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  auto& tensor = tensors[0];
+  auto data = std::make_unique<StagingWorkData>();
+  data->staging = get_staging_buffer(
+      at::empty({0}, tensor.options().dtype(torch_ucc_config.compression)),
+      tensor.numel());
+  at::Tensor wire = data->staging->buffer.narrow(0, 0, tensor.numel());
+  data->flat = {wire};
+  at::Tensor residual = get_compression_residual(
+      tensor, takeCompressionBucket(), tensor.numel());
+
+  ucc_coll_args_t coll;
+  coll.mask = UCC_COLL_ARGS_FIELD_FLAGS;
+  coll.flags = UCC_COLL_ARGS_FLAG_IN_PLACE;
+  coll.coll_type = UCC_COLL_TYPE_ALLREDUCE;
+  coll.op = to_ucc_reduceOp(opts.reduceOp, wire.scalar_type());
+  coll.src.info.buffer = nullptr;
+  coll.src.info.count = wire.numel();
+  coll.src.info.datatype = to_ucc_dType(wire);
+  coll.src.info.mem_type = UCC_MEMORY_TYPE_CUDA;
+  coll.dst.info.buffer = wire.data_ptr();
+  coll.dst.info.count = wire.numel();
+  coll.dst.info.datatype = to_ucc_dType(wire);
+  coll.dst.info.mem_type = UCC_MEMORY_TYPE_CUDA;
+  SAVE_TENSORS(tensors, data->dst);
+  // chunking and tracing see the wire buffer
+  std::vector<at::Tensor> wires{wire};
+  return collective_post(
+      OpType::ALLREDUCE,
+      [&, wire, residual]() {
+        if (residual.defined()) {
+          c10::cuda::CUDACachingAllocator::recordStream(
+              residual.storage().data_ptr(), *stream);
+        }
+        compress_tensor(tensor.view({-1}), wire, residual);
+      },
+      [&, wire]() { tensor.view({-1}).copy_(wire); },
+      coll,
+      std::move(data),
+      tensor.device(),
+      wires,
+      tensors,
+      "ucc:allreduce");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::
+    reduce_scatter_compressed(
+        std::vector<at::Tensor>& outputTensors,
+        std::vector<std::vector<at::Tensor>>& inputTensors,
+        const ReduceScatterOptions& opts) {
+  auto& inputs = inputTensors[0];
+  auto& output = outputTensors[0];
+  const int64_t numel = output.numel();
+  auto data = std::make_unique<StagingWorkData>();
+  // compressed inputs followed by compressed output
+  data->staging = get_staging_buffer(
+      at::empty({0}, output.options().dtype(torch_ucc_config.compression)),
+      numel * (size_ + 1));
+  at::Tensor wire_in = data->staging->buffer.narrow(0, 0, numel * size_);
+  at::Tensor wire_out = data->staging->buffer.narrow(0, numel * size_, numel);
+  data->flat = {wire_in, wire_out};
+  // one residual for all inputs
+  at::Tensor residual = get_compression_residual(
+      inputs[0], takeCompressionBucket(), numel * size_);
+
+  ucc_coll_args_t coll;
+  coll.mask = 0;
+  coll.flags = 0;
+  coll.coll_type = UCC_COLL_TYPE_REDUCE_SCATTER;
+  coll.op = to_ucc_reduceOp(opts.reduceOp, wire_in.scalar_type());
+  coll.src.info.buffer = wire_in.data_ptr();
+  coll.src.info.count = wire_in.numel();
+  coll.src.info.datatype = to_ucc_dType(wire_in);
+  coll.src.info.mem_type = UCC_MEMORY_TYPE_CUDA;
+  coll.dst.info.buffer = wire_out.data_ptr();
+  coll.dst.info.count = numel;
+  coll.dst.info.datatype = to_ucc_dType(wire_out);
+  coll.dst.info.mem_type = UCC_MEMORY_TYPE_CUDA;
+  SAVE_TENSORS(inputs, data->src);
+  SAVE_TENSORS(outputTensors, data->dst);
+  std::vector<at::Tensor> wires{wire_in};
+  return collective_post(
+      OpType::REDUCE_SCATTER,
+      [&, wire_in, residual]() {
+        if (residual.defined()) {
+          c10::cuda::CUDACachingAllocator::recordStream(
+              residual.storage().data_ptr(), *stream);
+        }
+        for (size_t j = 0; j < inputs.size(); j++) {
+          TORCH_CHECK(
+              inputs[j].numel() == numel, "Tensor operand counts must be same");
+          compress_tensor(
+              inputs[j].reshape({-1}),
+              wire_in.narrow(0, j * numel, numel),
+              residual.defined() ? residual.narrow(0, j * numel, numel)
+                                 : residual);
+        }
+      },
+      [&, wire_out]() { output.view({-1}).copy_(wire_out); },
+      coll,
+      std::move(data),
+      output.device(),
+      wires,
+      outputTensors,
+      "ucc:reduce_scatter");
+}
+#endif
+
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::allreduce_coalesced(
-    std::vector<at::Tensor>& /* unused */,
-    const AllreduceCoalescedOptions& /* unused */) {
-  throw std::runtime_error(
-      "ProcessGroupUCC does not support allreduce_coalesced");
+    std::vector<at::Tensor>& tensors,
+    const AllreduceCoalescedOptions& opts) {
+  TORCH_CHECK(!tensors.empty(), "allreduce_coalesced requires tensors");
+  auto& tensor = tensors[0];
+  int64_t total_numel = 0;
+  for (const auto& t : tensors) {
+    TORCH_CHECK(
+        t.device() == tensor.device(),
+        "allreduce_coalesced tensors must be on the same device");
+    TORCH_CHECK(
+        t.scalar_type() == tensor.scalar_type(),
+        "allreduce_coalesced tensors must have the same dtype");
+    TORCH_CHECK(
+        !t.is_sparse(), "allreduce_coalesced tensors have to be dense");
+    total_numel += t.numel();
+  }
+  initComm(tensor.device());
+
+  auto data = std::make_unique<StagingWorkData>();
+  data->staging = get_staging_buffer(tensor, total_numel);
+  at::Tensor flat = data->staging->buffer.narrow(0, 0, total_numel);
+
+  ucc_coll_args_t coll;
+  coll.mask = UCC_COLL_ARGS_FIELD_FLAGS;
+  coll.flags = UCC_COLL_ARGS_FLAG_IN_PLACE;
+  coll.coll_type = UCC_COLL_TYPE_ALLREDUCE;
+  coll.op = to_ucc_reduceOp(opts.reduceOp, tensor.scalar_type());
+  coll.src.info.buffer = nullptr;
+  coll.src.info.count = total_numel;
+  coll.src.info.datatype = to_ucc_dType(tensor);
+  coll.src.info.mem_type = to_ucc_memType(tensor.device().type());
+  coll.dst.info.buffer = flat.data_ptr();
+  coll.dst.info.count = total_numel;
+  coll.dst.info.datatype = to_ucc_dType(tensor);
+  coll.dst.info.mem_type = to_ucc_memType(tensor.device().type());
+  SAVE_TENSORS(tensors, data->dst);
+  data->flat = {flat};
+
+  auto pack = [this, &tensors, flat] {
+    std::vector<at::Tensor> views;
+    views.reserve(tensors.size());
+    for (auto& t : tensors) {
+#ifdef USE_CUDA
+      if (t.device().is_cuda()) {
+        c10::cuda::CUDACachingAllocator::recordStream(
+            t.storage().data_ptr(), (*stream));
+      }
+#endif
+      views.push_back(t.reshape({-1}));
+    }
+    at::cat_out(flat, views, 0);
+  };
+  // captures by value, for CPU it executes on the progress thread
+  auto unpack = [tensors, flat] {
+    int64_t offset = 0;
+    for (auto t : tensors) {
+      t.copy_(flat.narrow(0, offset, t.numel()).view_as(t), true);
+      offset += t.numel();
+    }
+  };
+  if (tensor.device().is_cuda()) {
+    return collective_post(
+        OpType::ALLREDUCE_COALESCED,
+        pack,
+        unpack,
+        coll,
+        std::move(data),
+        tensor.device(),
+        tensors,
+        tensors,
+        "ucc:allreduce_coalesced");
+  }
+  data->unpack = unpack;
+  return collective_post(
+      OpType::ALLREDUCE_COALESCED,
+      pack,
+      []() {},
+      coll,
+      std::move(data),
+      tensor.device(),
+      tensors,
+      tensors,
+      "ucc:allreduce_coalesced");
 }
 
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::alltoall(
@@ -1235,6 +4110,100 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::alltoall(
       "ucc:alltoall");
 }
 
+std::shared_ptr<const ProcessGroupUCC::AlltoallSplits> ProcessGroupUCC::
+    get_alltoall_splits(
+        const std::vector<int64_t>& outputSplitSizes,
+        const std::vector<int64_t>& inputSplitSizes,
+        const at::Tensor& outputTensor,
+        const at::Tensor& inputTensor) {
+  const int64_t input_rows = inputTensor.dim() > 0 ? inputTensor.size(0) : 1;
+  const int64_t output_rows =
+      outputTensor.dim() > 0 ? outputTensor.size(0) : 1;
+  const int64_t input_row_numel =
+      input_rows > 0 ? inputTensor.numel() / input_rows : 0;
+  const int64_t output_row_numel =
+      output_rows > 0 ? outputTensor.numel() / output_rows : 0;
+  auto matches = [&](const AlltoallSplits& s) {
+    return s.input_rows == input_rows && s.output_rows == output_rows &&
+        s.input_row_numel == input_row_numel &&
+        s.output_row_numel == output_row_numel &&
+        s.input_splits == inputSplitSizes &&
+        s.output_splits == outputSplitSizes;
+  };
+  {
+    std::lock_guard<std::mutex> lock(splits_mutex);
+    for (auto it = splits_cache.begin(); it != splits_cache.end(); ++it) {
+      if (matches(**it)) {
+        splits_cache.splice(splits_cache.begin(), splits_cache, it);
+        return splits_cache.front();
+      }
+    }
+  }
+  auto splits = std::make_shared<AlltoallSplits>();
+  splits->input_splits = inputSplitSizes;
+  splits->output_splits = outputSplitSizes;
+  splits->input_rows = input_rows;
+  splits->output_rows = output_rows;
+  splits->input_row_numel = input_row_numel;
+  splits->output_row_numel = output_row_numel;
+  splits->send_lengths.resize(size_);
+  splits->send_offsets.resize(size_);
+  splits->recv_lengths.resize(size_);
+  splits->recv_offsets.resize(size_);
+  computeLengthsAndOffsets(
+      outputSplitSizes,
+      outputTensor,
+      &splits->recv_lengths,
+      &splits->recv_offsets);
+  computeLengthsAndOffsets(
+      inputSplitSizes,
+      inputTensor,
+      &splits->send_lengths,
+      &splits->send_offsets);
+  if (torch_ucc_config.alltoall_splits_cache > 0) {
+    std::lock_guard<std::mutex> lock(splits_mutex);
+    splits_cache.push_front(splits);
+    if (splits_cache.size() > (size_t)torch_ucc_config.alltoall_splits_cache) {
+      splits_cache.pop_back();
+    }
+  }
+  return splits;
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::alltoallWithSplits(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes) {
+  TORCH_CHECK(
+      inputSplitSizes.size() == (size_t)size_,
+      "alltoallWithSplits needs a send split for every rank");
+  // the split exchange is waited on here, inside a group it never starts
+  TORCH_CHECK(
+      torch_ucc_group.depth == 0,
+      "alltoallWithSplits can't be issued between group_start and group_end");
+  c10d::checkSplitSizes(inputSplitSizes, inputTensor, size_);
+  // size_ int64 on every rank, completes eagerly below
+  // TORCH_UCC_EAGER_THRESHOLD
+  at::Tensor send_splits =
+      at::tensor(inputSplitSizes, at::TensorOptions().dtype(at::kLong));
+  at::Tensor recv_splits = at::empty({size_}, at::kLong);
+  std::vector<int64_t> equal;
+  alltoall_base(recv_splits, send_splits, equal, equal)->wait();
+  const int64_t* recv = recv_splits.data_ptr<int64_t>();
+  outputSplitSizes.assign(recv, recv + size_);
+
+  auto sizes = inputTensor.sizes().vec();
+  if (sizes.empty()) {
+    sizes.push_back(1);
+  }
+  sizes[0] = std::accumulate(
+      outputSplitSizes.begin(), outputSplitSizes.end(), (int64_t)0);
+  outputTensor = at::empty(sizes, inputTensor.options());
+  return alltoall_base(
+      outputTensor, inputTensor, outputSplitSizes, inputSplitSizes);
+}
+
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::alltoall_base(
     at::Tensor& outputTensor,
     at::Tensor& inputTensor,
@@ -1244,10 +4213,10 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::alltoall_base(
   check_device(inputTensor.device(), outputTensor.device());
   initComm(inputTensor.device());
   ucc_coll_args_t coll;
-  AlltoallWorkData* data;
+  WorkData* data;
 
   if ((outputSplitSizes.size() == 0) && (inputSplitSizes.size() == 0)) {
-    data = new AlltoallWorkData(0);
+    data = new WorkData();
     TORCH_CHECK(
         (outputTensor.size(0) % size_ == 0) &&
             (inputTensor.size(0) % size_ == 0),
@@ -1265,26 +4234,27 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::alltoall_base(
     coll.dst.info.mem_type = to_ucc_memType(outputTensor.device().type());
     coll.flags = 0;
   } else {
-    data = new AlltoallWorkData(size_);
     c10d::checkSplitSizes(inputSplitSizes, inputTensor, size_);
     c10d::checkSplitSizes(outputSplitSizes, outputTensor, size_);
-    computeLengthsAndOffsets(
-        outputSplitSizes,
-        outputTensor,
-        &data->recv_lengths,
-        &data->recv_offsets);
-    computeLengthsAndOffsets(
-        inputSplitSizes, inputTensor, &data->send_lengths, &data->send_offsets);
+    auto cached = new CachedAlltoallWorkData();
+    cached->splits = get_alltoall_splits(
+        outputSplitSizes, inputSplitSizes, outputTensor, inputTensor);
+    data = cached;
+    const AlltoallSplits& splits = *cached->splits;
+    // UCC only reads the arrays
+    auto counts = [](const std::vector<uint64_t>& v) {
+      return (ucc_count_t*)const_cast<uint64_t*>(v.data());
+    };
     coll.mask = UCC_COLL_ARGS_FIELD_FLAGS;
     coll.coll_type = UCC_COLL_TYPE_ALLTOALLV;
     coll.src.info_v.buffer = inputTensor.data_ptr();
-    coll.src.info_v.counts = (ucc_count_t*)data->send_lengths.data();
-    coll.src.info_v.displacements = (ucc_aint_t*)data->send_offsets.data();
+    coll.src.info_v.counts = counts(splits.send_lengths);
+    coll.src.info_v.displacements = (ucc_aint_t*)counts(splits.send_offsets);
     coll.src.info_v.datatype = to_ucc_dType(inputTensor);
     coll.src.info_v.mem_type = to_ucc_memType(inputTensor.device().type());
     coll.dst.info_v.buffer = outputTensor.data_ptr();
-    coll.dst.info_v.counts = (ucc_count_t*)data->recv_lengths.data();
-    coll.dst.info_v.displacements = (ucc_aint_t*)data->recv_offsets.data();
+    coll.dst.info_v.counts = counts(splits.recv_lengths);
+    coll.dst.info_v.displacements = (ucc_aint_t*)counts(splits.recv_offsets);
     coll.dst.info_v.datatype = to_ucc_dType(outputTensor);
     coll.dst.info_v.mem_type = to_ucc_memType(outputTensor.device().type());
     coll.flags = UCC_COLL_ARGS_FLAG_CONTIG_SRC_BUFFER |
@@ -1320,9 +4290,11 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::barrier(
   auto numGPUs = at::cuda::getNumGPUs();
   if (!opts.device_ids.empty()) {
     device = c10::Device(c10::DeviceType::CUDA, opts.device_ids.front());
-  } else if (comm && comm->cuda_device_index != TORCH_UCC_DEVICE_NOT_SET) {
-    device = c10::Device(c10::DeviceType::CUDA, comm->cuda_device_index);
+  } else if (stream) {
+    device = c10::Device(c10::DeviceType::CUDA, stream->device_index());
   } else if (numGPUs > 0) {
+    // communicator may be shared with groups on other devices, its device
+    // says nothing about this group
     int8_t deviceIdx = static_cast<int8_t>(c10::cuda::current_device());
     // if current device is 0, likely the device is not set, use the best guess
     if (0 == (int)deviceIdx) {
@@ -1522,54 +4494,76 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::reduce_scatter(
 	check_tensor(outputTensors);
 	check_device(inputTensors[0][0].device(), outputTensors[0].device());
 	initComm(inputTensors[0][0].device());
-  auto data = std::make_unique<WorkData>();
-	std::vector<at::Tensor> flat_input(inputTensors.size());
-  for (size_t i = 0; i < inputTensors.size(); i++) {
-    TORCH_CHECK(inputTensors[i].size() == inputTensors.size() * size_,
-      "Tensor input list is not valid for the number of participants");
-      flat_input[i] = c10d::newLikeFlat(inputTensors, i);
-  }
-  SAVE_TENSORS(flat_input, data->flat);
-	check_tensor(flat_input);
+  TORCH_CHECK(inputTensors[0].size() == (size_t)size_,
+    "Tensor input list is not valid for the number of participants");
+#ifdef USE_CUDA
+  if (use_compression(outputTensors[0], opts.reduceOp)) {
+    return reduce_scatter_compressed(outputTensors, inputTensors, opts);
+  }
+#endif
+  takeCompressionBucket();
+  auto data = std::make_unique<StagingWorkData>();
+  auto& inputs = inputTensors[0];
+  auto& output = outputTensors[0];
   ucc_coll_args_t coll;
   coll.mask = 0;
   coll.flags = 0;
   coll.coll_type = UCC_COLL_TYPE_REDUCE_SCATTER;
-	coll.op = to_ucc_reduceOp(opts.reduceOp, flat_input[0].scalar_type());
-
-  coll.src.info.buffer = flat_input[0].data_ptr();
-  coll.src.info.count = flat_input[0].numel();
-  coll.src.info.datatype = to_ucc_dType(flat_input[0]);
-  coll.src.info.mem_type = to_ucc_memType(flat_input[0].device().type());
-  coll.dst.info.buffer = outputTensors[0].data_ptr();
-  coll.dst.info.count = outputTensors[0].numel();
-  coll.dst.info.datatype = to_ucc_dType(outputTensors[0]);
-  coll.dst.info.mem_type = to_ucc_memType(outputTensors[0].device().type());
-
-  SAVE_TENSORS(inputTensors[0], data->src);
+	coll.op = to_ucc_reduceOp(opts.reduceOp, output.scalar_type());
+
+  coll.src.info.count = output.numel() * size_;
+  coll.src.info.datatype = to_ucc_dType(output);
+  coll.src.info.mem_type = to_ucc_memType(inputs[0].device().type());
+  coll.dst.info.buffer = output.data_ptr();
+  coll.dst.info.count = output.numel();
+  coll.dst.info.datatype = to_ucc_dType(output);
+  coll.dst.info.mem_type = to_ucc_memType(output.device().type());
+
+  SAVE_TENSORS(inputs, data->src);
   SAVE_TENSORS(outputTensors, data->dst);
 
-  auto copy_to_flat = [&] {
+  if (is_flat_view(inputs, output)) {
+    // inputs are chunks of one buffer, reduce from it directly
+    coll.src.info.buffer = inputs[0].data_ptr();
+    return collective_post(
+        OpType::REDUCE_SCATTER,
+        []() {},
+        []() {},
+        coll,
+        std::move(data),
+        inputs[0].device(),
+        inputs,
+        outputTensors,
+        "ucc:reduce_scatter");
+  }
+
+  data->staging = get_staging_buffer(output, output.numel() * size_);
+  std::vector<int64_t> flat_sizes{size_};
+  flat_sizes.insert(
+      flat_sizes.end(), output.sizes().begin(), output.sizes().end());
+  at::Tensor flat_input = data->staging->buffer.narrow(
+      0, 0, output.numel() * size_).view(flat_sizes);
+  data->flat = {flat_input};
+  coll.src.info.buffer = flat_input.data_ptr();
+
+  auto copy_to_flat = [&, flat_input] {
     bool asyncCopy = false;
-    auto isize = inputTensors.size();
 #ifdef USE_CUDA
-    bool isCuda = inputTensors[0][0].device().is_cuda();
+    bool isCuda = inputs[0].device().is_cuda();
 #endif
-    for (size_t i = 0; i < isize; i++) {
-      auto onumel = outputTensors[i].numel();
-      for (size_t j = 0; j < inputTensors[i].size(); j++) {
-        TORCH_CHECK(
-          (inputTensors[i][j].numel() == onumel),
-          "Tensor operand counts must be same");
+    auto onumel = output.numel();
+    for (size_t j = 0; j < inputs.size(); j++) {
+      TORCH_CHECK(
+        (inputs[j].numel() == onumel),
+        "Tensor operand counts must be same");
 #ifdef USE_CUDA
-        if (isCuda) {
-          c10::cuda::CUDACachingAllocator::recordStream(
-            inputTensors[i][j].storage().data_ptr(), (*stream));
-          asyncCopy = true;
-        }
-#endif
-        flat_input[i][j].copy_(inputTensors[i][j], asyncCopy);
+      if (isCuda) {
+        c10::cuda::CUDACachingAllocator::recordStream(
+          inputs[j].storage().data_ptr(), (*stream));
+        asyncCopy = true;
       }
+#endif
+      flat_input[j].copy_(inputs[j], asyncCopy);
     }
   };
 
@@ -1579,8 +4573,8 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::reduce_scatter(
       []() {},
     	coll,
     	std::move(data),
-    	inputTensors[0][0].device(),
-      inputTensors[0],
+    	inputs[0].device(),
+      inputs,
     	outputTensors,
     	"ucc:reduce_scatter");
 }
@@ -1661,6 +4655,7 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::send(
     std::vector<at::Tensor>& tensors,
     int dstRank,
     int tag) {
+  torch_ucc_group_error_guard group_guard;
   check_tensor(tensors);
   auto& tensor = tensors[0];
   initComm(tensor.device());
@@ -1695,14 +4690,16 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::send(
 #else
   ucp_tag_t ucp_tag;
   TORCH_UCX_MAKE_SEND_TAG(ucp_tag, tag, rank_, comm_id);
-  ucc_coll_req_h request = comm->send_nb(
-      eps[dstRank],
+  auto entry = comm->send_nb(
+      comm->ucx_get_ep(*eps, dstRank),
       tensor.data_ptr(),
       to_ucs_memType(tensor.device().type()),
       tensor.numel() * tensor.element_size(),
-      ucp_tag);
+      ucp_tag,
+      metrics);
 
-  auto work = comm->enqueue_p2p(OpType::SEND, request, "ucc:send");
+  auto work = comm->enqueue_p2p(
+      OpType::SEND, std::move(entry), "ucc:send", default_wait_timeout());
   // TODO: record src, dst ranks and tag
   RECORD_COMMS_TRACE(
       logger->trace_generator,
@@ -1720,6 +4717,7 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::recv(
     std::vector<at::Tensor>& tensors,
     int srcRank,
     int tag) {
+  torch_ucc_group_error_guard group_guard;
   check_tensor(tensors);
   auto& tensor = tensors[0];
   initComm(tensor.device());
@@ -1754,14 +4752,16 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::recv(
 #else
   ucp_tag_t ucp_tag, ucp_tag_mask;
   TORCH_UCX_MAKE_RECV_TAG(ucp_tag, ucp_tag_mask, tag, srcRank, comm_id);
-  ucc_coll_req_h request = comm->recv_nb(
+  auto entry = comm->recv_nb(
       tensor.data_ptr(),
       to_ucs_memType(tensor.device().type()),
       tensor.numel() * tensor.element_size(),
       ucp_tag,
-      ucp_tag_mask);
+      ucp_tag_mask,
+      metrics);
 
-  auto work = comm->enqueue_p2p(OpType::RECV, request, "ucc:recv");
+  auto work = comm->enqueue_p2p(
+      OpType::RECV, std::move(entry), "ucc:recv", default_wait_timeout());
   // TODO: record src, dst ranks and tag
   RECORD_COMMS_TRACE(
       logger->trace_generator,
@@ -1778,6 +4778,7 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::recv(
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::recvAnysource(
     std::vector<at::Tensor>& tensors,
     int tag) {
+  torch_ucc_group_error_guard group_guard;
   check_tensor(tensors);
   auto& tensor = tensors[0];
   initComm(tensor.device());
@@ -1785,14 +4786,20 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupUCC::recvAnysource(
   ucp_tag_t ucp_tag, ucp_tag_mask;
   TORCH_UCX_MAKE_RECV_TAG(
       ucp_tag, ucp_tag_mask, tag, TORCH_UCX_ANY_SOURCE, comm_id);
-  ucc_coll_req_h request = comm->recv_nb(
+  auto entry = comm->recv_nb(
       tensor.data_ptr(),
       to_ucs_memType(tensor.device().type()),
       tensor.numel() * tensor.element_size(),
       ucp_tag,
-      ucp_tag_mask);
-
-  auto work = comm->enqueue_p2p(OpType::RECVANYSOURCE, request, "ucc:recv");
+      ucp_tag_mask,
+      metrics);
+
+  auto work =
+      comm->enqueue_p2p(
+          OpType::RECVANYSOURCE,
+          std::move(entry),
+          "ucc:recv",
+          default_wait_timeout());
   // TODO: record dst rank and tag
   RECORD_COMMS_TRACE(
       logger->trace_generator,
@@ -1813,43 +4820,101 @@ c10::intrusive_ptr<ProcessGroup> ProcessGroupUCC::createProcessGroupUCC(
   return c10::make_intrusive<ProcessGroupUCC>(store, rank, size, timeout);
 }
 
+void ProcessGroupUCC::createTeam(c10::Device dev) {
+  if (torch_ucc_config.team_cache) {
+    comm->ucc_acquire_team(team, eps, oob, dev);
+    TORCH_UCC_LOG_INFO(
+        TORCH_UCC_INIT, "Successfully initialized UCX and UCC libraries");
+    return;
+  }
+  // endpoints might already be connected by asynchronous initialization
+  if (eps->eps.empty()) {
+    comm->ucx_connect_eps(*eps, oob);
+    TORCH_UCC_LOG_INFO(
+        TORCH_UCC_INIT, "Successfully initialized UCX library");
+  }
+  comm->ucc_create_team(team, oob);
+  TORCH_UCC_LOG_INFO(TORCH_UCC_INIT, "Successfully initialized UCC library");
+}
+
+void ProcessGroupUCC::initCommAsync() {
+  // communicator ids are assigned in group creation order, which is the same
+  // on all ranks, so this part can't run in the background. Device is not
+  // known yet, the communicator picks it up from the first collective.
+  comm = CommPG::get_comm(comm_id, c10::Device(c10::kCPU), oob, logger);
+  if (torch_ucc_config.team_cache) {
+    // cached endpoints come with the team, both are acquired on first use
+    return;
+  }
+  init_thread = std::thread([this]() {
+    try {
+      comm->ucx_connect_eps(*eps, oob);
+      TORCH_UCC_LOG_INFO(
+          TORCH_UCC_INIT, "Successfully initialized UCX library");
+    } catch (...) {
+      init_eptr = std::current_exception();
+    }
+  });
+}
+
 void ProcessGroupUCC::initComm(c10::Device dev) {
-  if (!comm) {
+  if (init_thread.joinable()) {
+    init_thread.join();
+    if (init_eptr) {
+      TORCH_UCC_LOG_ERROR(TORCH_UCC_INIT, "asynchronous initialization failed");
+    }
+  }
+  if (init_eptr) {
+    std::rethrow_exception(init_eptr);
+  }
+  if (!team) {
 #ifdef USE_CUDA
+    // team gets bound to the device of the first collective
     if (dev.is_cuda()) {
       c10::cuda::set_device(dev.index());
     }
 #endif
-    comm = CommPG::get_comm(comm_id, dev, oob, logger);
-    comm->ucx_connect_eps(eps, oob);
-    TORCH_UCC_LOG_INFO(TORCH_UCC_INIT, "Successfully initialized UCX library");
-    comm->ucc_create_team(team, oob);
-    TORCH_UCC_LOG_INFO(TORCH_UCC_INIT, "Successfully initialized UCC library");
-    logger->setPhase(TORCH_UCC_READY);
-  } else {
-    if (dev.is_cuda()) {
-      if ((comm->cuda_device_index != TORCH_UCC_DEVICE_NOT_SET) &&
-          (comm->cuda_device_index != dev.index())) {
-        TORCH_UCC_LOG_ERROR(
-            TORCH_UCC_INIT,
-            "ucc communicator was initialized with different cuda device,"
-            "multi device is not supported");
-        throw std::runtime_error(ucc_status_string(UCC_ERR_NOT_SUPPORTED));
-      }
-      comm->cuda_device_index = dev.index();
+    if (!comm) {
+      comm = CommPG::get_comm(comm_id, dev, oob, logger);
+    }
+    try {
+      createTeam(dev);
+    } catch (...) {
+      // peers won't repeat team creation, don't retry it on the next call
+      init_eptr = std::current_exception();
+      throw;
     }
+    logger->setPhase(TORCH_UCC_READY);
+  }
+  if (dev.is_cuda() && comm->cuda_device_index == TORCH_UCC_DEVICE_NOT_SET) {
+    comm->cuda_device_index = dev.index();
   }
 #ifdef USE_CUDA
-  if (!cuda_ee && dev.is_cuda()) {
-    stream = std::make_unique<at::cuda::CUDAStream>(
-        at::cuda::getStreamFromPool(true, dev.index()));
-    ucc_ee_params_t params;
-    params.ee_type = UCC_EE_CUDA_STREAM;
-    params.ee_context = (void*)stream->stream();
-    params.ee_context_size = sizeof(cudaStream_t);
-    TORCH_UCC_CHECK(
-        ucc_ee_create(team, &params, &cuda_ee),
-        "failed to create UCC execution engine");
+  if (dev.is_cuda()) {
+    if (!stream) {
+      // one stream and execution engine per team: collectives of the group
+      // are ordered as issued, as TLs like NCCL require
+      stream = std::make_unique<at::cuda::CUDAStream>(
+          at::cuda::getStreamFromPool(true, dev.index()));
+      ucc_ee_params_t params;
+      params.ee_type = UCC_EE_CUDA_STREAM;
+      params.ee_context = (void*)stream->stream();
+      params.ee_context_size = sizeof(cudaStream_t);
+      TORCH_UCC_CHECK(
+          ucc_ee_create(team, &params, &cuda_ee),
+          "failed to create UCC execution engine");
+      refillCaptureEvents();
+    } else if (stream->device_index() != dev.index()) {
+      // UCC team and its TLs are bound to the device they were created on
+      TORCH_UCC_LOG_ERROR(
+          TORCH_UCC_INIT,
+          c10::str(
+              "process group was initialized with cuda device ",
+              (int)stream->device_index(),
+              ", got tensor on ",
+              dev.str()));
+      throw std::runtime_error(ucc_status_string(UCC_ERR_NOT_SUPPORTED));
+    }
   }
 #endif
 }
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include "torch_ucc_bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+
+#ifdef USE_CUDA
+#include <c10/cuda/CUDAStream.h>
+#endif
+
+namespace c10d {
+
+namespace {
+
+using bench_op_t = std::function<c10::intrusive_ptr<ProcessGroup::Work>()>;
+
+at::Tensor bench_tensor(int64_t numel, c10::Device dev) {
+  return at::ones(
+      {numel}, at::TensorOptions().dtype(at::kFloat).device(dev));
+}
+
+std::vector<at::Tensor> bench_tensors(int n, int64_t numel, c10::Device dev) {
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(n);
+  for (int i = 0; i < n; i++) {
+    tensors.push_back(bench_tensor(numel, dev));
+  }
+  return tensors;
+}
+
+// Uneven alltoallv pattern, elements rank p sends to rank q. Symmetric in p
+// and q so send and receive splits of a rank are the same, averages to about
+// piece elements per peer.
+int64_t bench_split(int p, int q, int n, int64_t piece) {
+  return std::max<int64_t>(1, piece / 2 + piece * ((p + q) % n) / n);
+}
+
+// Returns callable issuing one operation, buffers are owned by the callable.
+bench_op_t make_bench_op(
+    ProcessGroupUCC& pg,
+    const std::string& op,
+    int64_t size,
+    c10::Device dev) {
+  const int n = pg.getSize();
+  const int rank = pg.getRank();
+  const int64_t count = std::max<int64_t>(1, size / sizeof(float));
+  // per rank piece of gathered and scattered buffers
+  const int64_t piece = std::max<int64_t>(1, count / n);
+
+  if (op == "allreduce") {
+    std::vector<at::Tensor> t{bench_tensor(count, dev)};
+    return [&pg, t]() mutable { return pg.allreduce(t); };
+  }
+  if (op == "broadcast") {
+    std::vector<at::Tensor> t{bench_tensor(count, dev)};
+    return [&pg, t]() mutable { return pg.broadcast(t); };
+  }
+  if (op == "reduce") {
+    std::vector<at::Tensor> t{bench_tensor(count, dev)};
+    return [&pg, t]() mutable { return pg.reduce(t); };
+  }
+  if (op == "allgather") {
+    std::vector<at::Tensor> in{bench_tensor(piece, dev)};
+    std::vector<std::vector<at::Tensor>> out{bench_tensors(n, piece, dev)};
+    return [&pg, in, out]() mutable { return pg.allgather(out, in); };
+  }
+  if (op == "allgather_base") {
+    at::Tensor in = bench_tensor(piece, dev);
+    at::Tensor out = bench_tensor(piece * n, dev);
+    return [&pg, in, out]() mutable { return pg._allgather_base(out, in); };
+  }
+  if (op == "reduce_scatter") {
+    std::vector<at::Tensor> out{bench_tensor(piece, dev)};
+    std::vector<std::vector<at::Tensor>> in{bench_tensors(n, piece, dev)};
+    return [&pg, in, out]() mutable { return pg.reduce_scatter(out, in); };
+  }
+  if (op == "alltoall") {
+    std::vector<at::Tensor> in = bench_tensors(n, piece, dev);
+    std::vector<at::Tensor> out = bench_tensors(n, piece, dev);
+    return [&pg, in, out]() mutable { return pg.alltoall(out, in); };
+  }
+  if (op == "alltoall_base" || op == "alltoallv") {
+    std::vector<int64_t> splits;
+    int64_t total = piece * n;
+    if (op == "alltoallv") {
+      total = 0;
+      for (int q = 0; q < n; q++) {
+        splits.push_back(bench_split(rank, q, n, piece));
+        total += splits.back();
+      }
+    }
+    at::Tensor in = bench_tensor(total, dev);
+    at::Tensor out = bench_tensor(total, dev);
+    return [&pg, in, out, splits]() mutable {
+      std::vector<int64_t> out_splits = splits;
+      std::vector<int64_t> in_splits = splits;
+      return pg.alltoall_base(out, in, out_splits, in_splits);
+    };
+  }
+  if (op == "gather") {
+    std::vector<at::Tensor> in{bench_tensor(piece, dev)};
+    std::vector<std::vector<at::Tensor>> out;
+    if (rank == 0) {
+      out.push_back(bench_tensors(n, piece, dev));
+    }
+    return [&pg, in, out]() mutable { return pg.gather(out, in); };
+  }
+  if (op == "scatter") {
+    std::vector<at::Tensor> out{bench_tensor(piece, dev)};
+    std::vector<std::vector<at::Tensor>> in;
+    if (rank == 0) {
+      in.push_back(bench_tensors(n, piece, dev));
+    }
+    return [&pg, in, out]() mutable { return pg.scatter(out, in); };
+  }
+  if (op == "barrier") {
+    return [&pg]() { return pg.barrier(); };
+  }
+  throw std::runtime_error("unknown benchmark operation " + op);
+}
+
+void bench_sync(c10::Device dev) {
+#ifdef USE_CUDA
+  if (dev.is_cuda()) {
+    // wait only orders the current stream after the collective
+    c10::cuda::getCurrentCUDAStream(dev.index()).synchronize();
+  }
+#endif
+}
+
+double elapsed_us(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+std::vector<std::string> benchmarkOps() {
+  return {
+      "allreduce",
+      "allgather",
+      "allgather_base",
+      "reduce_scatter",
+      "broadcast",
+      "reduce",
+      "alltoall",
+      "alltoall_base",
+      "alltoallv",
+      "gather",
+      "scatter",
+      "sendrecv",
+      "barrier"};
+}
+
+std::vector<double> runBenchmark(
+    ProcessGroupUCC& pg,
+    const std::string& op,
+    int64_t size,
+    c10::Device dev,
+    int warmup,
+    int iters) {
+  std::vector<double> times(std::max(iters, 0), 0.0);
+  if (op == "sendrecv") {
+    // ping-pong between ranks 2k and 2k + 1, last rank idles if group
+    // size is odd
+    const int rank = pg.getRank();
+    const int peer = rank ^ 1;
+    std::vector<at::Tensor> t{
+        bench_tensor(std::max<int64_t>(1, size / sizeof(float)), dev)};
+    pg.barrier()->wait();
+    if (peer >= pg.getSize()) {
+      return times;
+    }
+    auto pingpong = [&]() {
+      if (rank % 2 == 0) {
+        pg.send(t, peer, 0)->wait();
+        pg.recv(t, peer, 0)->wait();
+      } else {
+        pg.recv(t, peer, 0)->wait();
+        pg.send(t, peer, 0)->wait();
+      }
+      bench_sync(dev);
+    };
+    for (int i = 0; i < warmup; i++) {
+      pingpong();
+    }
+    for (int i = 0; i < iters; i++) {
+      auto start = std::chrono::steady_clock::now();
+      pingpong();
+      times[i] = elapsed_us(start) / 2;
+    }
+    return times;
+  }
+
+  bench_op_t issue = make_bench_op(pg, op, size, dev);
+  for (int i = 0; i < warmup; i++) {
+    issue()->wait();
+    bench_sync(dev);
+  }
+  pg.barrier()->wait();
+  for (int i = 0; i < iters; i++) {
+    auto start = std::chrono::steady_clock::now();
+    issue()->wait();
+    bench_sync(dev);
+    times[i] = elapsed_us(start);
+  }
+  return times;
+}
+
+} // namespace c10d
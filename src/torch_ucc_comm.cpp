@@ -11,11 +11,15 @@
 #include "torch_ucc_comm.hpp"
 #include "torch_ucc_tracing.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 namespace c10d {
 
 CommUCX::CommUCX(
     int comm_size,
-    const c10::intrusive_ptr<ProcessGroupUCCLogger>& logger)
+    const c10::intrusive_ptr<ProcessGroupUCCLogger>& logger,
+    bool enable_wakeup)
     : CommBase(logger) {
   ucp_params_t params;
   ucp_config_t* config;
@@ -39,6 +43,10 @@ CommUCX::CommUCX(
       UCP_PARAM_FIELD_REQUEST_INIT | UCP_PARAM_FIELD_REQUEST_CLEANUP;
   params.request_size = sizeof(ucc_coll_req_t);
   params.features = UCP_FEATURE_TAG;
+  if (enable_wakeup) {
+    // required by ucp_worker_get_efd/ucp_worker_arm
+    params.features |= UCP_FEATURE_WAKEUP;
+  }
   params.estimated_num_eps = comm_size;
   params.tag_sender_mask = TORCH_UCX_RANK_MASK;
   params.request_init = [](void* request) {
@@ -82,6 +90,39 @@ CommUCX::~CommUCX() {
   context = nullptr;
 }
 
+namespace {
+
+// State of an OOB allgather done with Bruck's algorithm over the store. At
+// step k every rank passes the blocks it has collected so far to rank - 2^k,
+// so a rank does log2(size) set/get pairs and every key has a single reader.
+struct torch_ucc_oob_allgather_req_t {
+  torch_ucc_oob_coll_info_t* info;
+  uint64_t seq;
+  void* rbuf;
+  size_t msglen;
+  int step;
+  // blocks of rank, rank + 1, ... collected so far
+  int num_blocks;
+  std::vector<uint8_t> blocks;
+
+  std::string stepKey(int step_, int dst) {
+    return info->getKey(
+        "teamr" + std::to_string(seq) + "_" + std::to_string(step_) + "_" +
+        std::to_string(dst));
+  }
+
+  void sendStep() {
+    const int dist = 1 << step;
+    const int count = std::min(dist, info->size - dist);
+    const int dst = (info->rank - dist + info->size) % info->size;
+    std::vector<uint8_t> val(
+        blocks.begin(), blocks.begin() + (size_t)count * msglen);
+    info->store->set(stepKey(step, dst), val);
+  }
+};
+
+} // namespace
+
 ucc_status_t oob_allgather(
     void* sbuf,
     void* rbuf,
@@ -90,74 +131,105 @@ ucc_status_t oob_allgather(
     void** req) {
   torch_ucc_oob_coll_info_t* info =
       reinterpret_cast<torch_ucc_oob_coll_info_t*>(coll_info);
-  std::vector<uint8_t> val = std::vector<uint8_t>(
-      reinterpret_cast<uint8_t*>(sbuf),
-      reinterpret_cast<uint8_t*>(sbuf) + msglen);
+  auto ag = new torch_ucc_oob_allgather_req_t();
+  ag->info = info;
+  ag->seq = info->oob_seq++;
+  ag->rbuf = rbuf;
+  ag->msglen = msglen;
+  ag->step = 0;
+  ag->num_blocks = 1;
+  ag->blocks.resize(msglen * info->size);
+  memcpy(ag->blocks.data(), sbuf, msglen);
   try {
-    info->store->set(info->getKey("teamr" + std::to_string(info->rank)), val);
-    info->rbuf = rbuf;
-    info->msglen = msglen;
-    *req = coll_info;
+    if (info->size > 1) {
+      ag->sendStep();
+    }
   } catch (std::exception& ex) {
     LOG(ERROR) << "(oob_allgather) Caught exception in Store Operation .. "
                << "[" << ex.what() << "]";
+    delete ag;
     return UCC_ERR_NO_MESSAGE;
   }
+  *req = ag;
   return UCC_OK;
 }
 
-ucc_status_t oob_allgather_test(void* req) {
-  torch_ucc_oob_coll_info_t* info =
-      reinterpret_cast<torch_ucc_oob_coll_info_t*>(req);
+namespace {
+
+// Advances allgather as far as received blocks allow. Blocking waits for
+// every step with a single store get instead of polling with check.
+ucc_status_t oob_allgather_progress(
+    torch_ucc_oob_allgather_req_t* ag,
+    bool blocking) {
+  torch_ucc_oob_coll_info_t* info = ag->info;
 
   try {
-    for (int r = 0; r < info->size; r++) {
-      if (!info->store->check({info->getKey("teamr" + std::to_string(r))})) {
+    while (ag->num_blocks < info->size) {
+      std::string key = ag->stepKey(ag->step, info->rank);
+      if (!blocking && !info->store->check({key})) {
         return UCC_INPROGRESS;
       }
-    }
-    for (int r = 0; r < info->size; r++) {
-      std::vector<uint8_t> data =
-          info->store->get(info->getKey("teamr" + std::to_string(r)));
+      std::vector<uint8_t> data = info->store->get(key);
+      info->store->deleteKey(key);
       memcpy(
-          (void*)((ptrdiff_t)info->rbuf + info->msglen * r),
+          ag->blocks.data() + (size_t)ag->num_blocks * ag->msglen,
           data.data(),
-          info->msglen);
+          data.size());
+      ag->num_blocks += data.size() / ag->msglen;
+      ag->step++;
+      if (ag->num_blocks < info->size) {
+        ag->sendStep();
+      }
     }
   } catch (std::exception& ex) {
     LOG(ERROR) << "(oob_allgather) Caught exception in Store Operation .. "
                << "[" << ex.what() << "]";
     return UCC_ERR_NO_MESSAGE;
   }
+  // blocks start with own data, rotate them into rank order
+  for (int i = 0; i < info->size; i++) {
+    memcpy(
+        (void*)((ptrdiff_t)ag->rbuf +
+                ag->msglen * ((info->rank + i) % info->size)),
+        ag->blocks.data() + (size_t)i * ag->msglen,
+        ag->msglen);
+  }
   return UCC_OK;
 }
 
+} // namespace
+
+ucc_status_t oob_allgather_test(void* req) {
+  return oob_allgather_progress(
+      reinterpret_cast<torch_ucc_oob_allgather_req_t*>(req), false);
+}
+
 ucc_status_t oob_allgather_free(void* req) {
-  torch_ucc_oob_coll_info_t* info =
-      reinterpret_cast<torch_ucc_oob_coll_info_t*>(req);
-  try {
-    int num_done = info->store->add({info->getKey("ag_done")}, 1);
-    if (num_done == info->size) {
-      info->store->deleteKey(info->getKey("ag_done"));
-      for (int r = 0; r < info->size; r++) {
-        info->store->deleteKey(info->getKey("teamr" + std::to_string(r)));
-      }
-      for (int r = 0; r < info->size; r++) {
-        info->store->add({info->getKey("ag_free" + std::to_string(r))}, 1);
-      }
-    } else {
-      info->store->wait({info->getKey("ag_free" + std::to_string(info->rank))});
-    }
-    info->store->deleteKey(
-        info->getKey("ag_free" + std::to_string(info->rank)));
-  } catch (std::exception& ex) {
-    LOG(ERROR) << "(oob_allgather) Caught exception in Store Operation .. "
-               << "[" << ex.what() << "]";
-    return UCC_ERR_NO_MESSAGE;
-  }
+  // every key is deleted by its reader, nothing to synchronize
+  delete reinterpret_cast<torch_ucc_oob_allgather_req_t*>(req);
   return UCC_OK;
 }
 
+void oob_allgather_sync(
+    torch_ucc_oob_coll_info_t* info,
+    void* sbuf,
+    void* rbuf,
+    size_t msglen) {
+  void* req;
+  ucc_status_t st = oob_allgather(sbuf, rbuf, msglen, info, &req);
+  if (st != UCC_OK) {
+    throw std::runtime_error(ucc_status_string(st));
+  }
+  // store get waits on the server, ranks don't poll it while the others
+  // catch up
+  st = oob_allgather_progress(
+      reinterpret_cast<torch_ucc_oob_allgather_req_t*>(req), true);
+  oob_allgather_free(req);
+  if (st != UCC_OK) {
+    throw std::runtime_error(ucc_status_string(st));
+  }
+}
+
 CommUCC::CommUCC(
     std::shared_ptr<torch_ucc_oob_coll_info_t> oob,
     const c10::intrusive_ptr<ProcessGroupUCCLogger>& logger)
@@ -2,6 +2,28 @@
 #include <pybind11/chrono.h>
 
 #include "torch_ucc.hpp"
+#include "torch_ucc_bench.hpp"
+
+namespace {
+
+c10::intrusive_ptr<c10d::ProcessGroupUCC> to_ucc_pg(
+    const c10::intrusive_ptr<c10d::ProcessGroup>& pg) {
+  auto ucc_pg = c10::dynamic_intrusive_pointer_cast<c10d::ProcessGroupUCC>(pg);
+  TORCH_CHECK(ucc_pg, "process group is not a ProcessGroupUCC");
+  return ucc_pg;
+}
+
+#ifdef USE_CUDA
+c10::intrusive_ptr<c10d::ProcessGroupUCC::WorkUCC> to_ucc_work(
+    const c10::intrusive_ptr<c10d::ProcessGroup::Work>& work) {
+  auto ucc_work =
+      c10::dynamic_intrusive_pointer_cast<c10d::ProcessGroupUCC::WorkUCC>(work);
+  TORCH_CHECK(ucc_work, "work is not a ProcessGroupUCC work");
+  return ucc_work;
+}
+#endif
+
+} // namespace
 
 static void __attribute__((constructor)) ProcessGroupUCCConstructor() {
   py::object module = py::module::import("torch.distributed");
@@ -12,4 +34,166 @@ static void __attribute__((constructor)) ProcessGroupUCCConstructor() {
 
 PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
   m.def("createProcessGroupUCC", &c10d::ProcessGroupUCC::createProcessGroupUCC);
+  m.def(
+      "set_persistent_collectives",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg, bool enable) {
+        to_ucc_pg(pg)->setPersistentCollectives(enable);
+      },
+      py::arg("pg"),
+      py::arg("enable"));
+  m.def(
+      "clear_persistent_collectives",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg) {
+        to_ucc_pg(pg)->clearPersistentCollectives();
+      },
+      py::arg("pg"));
+  m.def(
+      "get_metrics",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg) {
+        py::list result;
+        auto metrics = to_ucc_pg(pg)->getMetrics();
+        if (!metrics) {
+          return result;
+        }
+        for (const auto& it : metrics->snapshot()) {
+          const auto& cell = it.second;
+          const double count = cell.count;
+          const uint64_t transfer_ns = cell.queue_ns + cell.inflight_ns;
+          py::dict d;
+          d["op"] = c10d::opTypeToString(it.first.first);
+          d["size_bucket"] = it.first.second;
+          d["count"] = cell.count;
+          d["bytes"] = cell.bytes;
+          d["avg_setup_us"] = cell.setup_ns / count / 1e3;
+          d["avg_queue_us"] = cell.queue_ns / count / 1e3;
+          d["avg_inflight_us"] = cell.inflight_ns / count / 1e3;
+          d["avg_complete_us"] = cell.complete_ns / count / 1e3;
+          d["max_us"] = cell.max_ns / 1e3;
+          // bytes per second from post to completion
+          d["bandwidth"] =
+              transfer_ns ? cell.bytes * 1e9 / transfer_ns : 0.0;
+          d["latency_hist"] = std::vector<uint64_t>(
+              cell.latency.begin(), cell.latency.end());
+          result.append(d);
+        }
+        return result;
+      },
+      py::arg("pg"));
+  m.def(
+      "reset_metrics",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg) {
+        auto metrics = to_ucc_pg(pg)->getMetrics();
+        if (metrics) {
+          metrics->reset();
+        }
+      },
+      py::arg("pg"));
+  m.def("bench_ops", &c10d::benchmarkOps);
+  m.def(
+      "bench",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg,
+         const std::string& op,
+         int64_t size,
+         c10::Device device,
+         int warmup,
+         int iters) {
+        auto ucc_pg = to_ucc_pg(pg);
+        // timed loop doesn't touch Python objects
+        py::gil_scoped_release release;
+        return c10d::runBenchmark(*ucc_pg, op, size, device, warmup, iters);
+      },
+      py::arg("pg"),
+      py::arg("op"),
+      py::arg("size"),
+      py::arg("device"),
+      py::arg("warmup") = 10,
+      py::arg("iters") = 100);
+  m.def(
+      "tune",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg,
+         c10::Device device) {
+        auto ucc_pg = to_ucc_pg(pg);
+        py::gil_scoped_release release;
+        ucc_pg->tune(device);
+      },
+      py::arg("pg"),
+      py::arg("device"));
+  m.def(
+      "get_tuning",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg) {
+        py::list result;
+        const auto& table = to_ucc_pg(pg)->getTuneTable();
+        for (auto dev : {c10::DeviceType::CPU, c10::DeviceType::CUDA}) {
+          if (!table.ready(dev)) {
+            continue;
+          }
+          const auto& rows = table.rows(dev);
+          for (int op = 0; op < c10d::TORCH_UCC_TUNE_LAST; op++) {
+            for (int b = 0; b < c10d::ProcessGroupUCCTuneTable::kBuckets;
+                 b++) {
+              if (rows[op][b] < 0) {
+                continue;
+              }
+              py::dict d;
+              d["device"] = c10::DeviceTypeName(dev, true);
+              d["op"] = c10d::torch_ucc_tune_op_name(
+                  (c10d::torch_ucc_tune_op_t)op);
+              d["size_bucket"] = b;
+              d["choice"] = (int)rows[op][b];
+              result.append(d);
+            }
+          }
+        }
+        return result;
+      },
+      py::arg("pg"));
+  m.def(
+      "alltoall_with_splits",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg,
+         at::Tensor input,
+         std::vector<int64_t> input_splits) {
+        auto ucc_pg = to_ucc_pg(pg);
+        at::Tensor output;
+        std::vector<int64_t> output_splits;
+        c10::intrusive_ptr<c10d::ProcessGroup::Work> work;
+        {
+          // convenience wrapper, the split exchange blocks before the data
+          // alltoall is posted
+          py::gil_scoped_release release;
+          work = ucc_pg->alltoallWithSplits(
+              output, input, output_splits, input_splits);
+        }
+        return py::make_tuple(work, output, output_splits);
+      },
+      py::arg("pg"),
+      py::arg("input"),
+      py::arg("input_splits"));
+  m.def(
+      "buffer_pool_bytes",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup>& pg) {
+        return to_ucc_pg(pg)->getBufferPoolBytes();
+      },
+      py::arg("pg"));
+  m.def(
+      "set_compression_bucket",
+      &c10d::ProcessGroupUCC::setCompressionBucket,
+      py::arg("bucket"));
+  m.def("group_start", &c10d::ProcessGroupUCC::groupStart);
+  m.def("group_end", &c10d::ProcessGroupUCC::groupEnd);
+  m.def("clear_memh_cache", &c10d::ProcessGroupUCC::clearMemhCache);
+#ifdef USE_CUDA
+  m.def(
+      "work_num_chunks",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup::Work>& work) {
+        return to_ucc_work(work)->numChunks();
+      },
+      py::arg("work"));
+  m.def(
+      "wait_chunk",
+      [](const c10::intrusive_ptr<c10d::ProcessGroup::Work>& work, size_t i) {
+        to_ucc_work(work)->blockChunk(i);
+      },
+      py::arg("work"),
+      py::arg("chunk"));
+#endif
 }
@@ -12,9 +12,10 @@
 #include <c10d/ParamCommsUtils.hpp>
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <fstream>
 
 #ifdef FBCODE_CAFFE2
 #include "torch_ucc_internal_utils.hpp"
@@ -22,22 +23,30 @@
 
 namespace c10d {
 
-void ProcessGroupUCCLogger::initCommsTracer() {
-  trace_generator = std::make_shared<CommTraceLogger>();
-  initialized_CommTraceLogger = true;
+namespace {
+
+size_t env_or(const char* name, size_t value) {
+  char* env = std::getenv(name);
+  return env ? std::stoull(env) : value;
 }
 
-void ProcessGroupUCCLogger::flushComms(int rank, int world_size) {
-  if (!initialized_CommTraceLogger ||
-      trace_generator->getCommsTrace().empty()) {
-    return;
-  }
+} // namespace
 
-  std::string dirname = c10::str("ProcessGroupUCC_trace_np", world_size);
+void ProcessGroupUCCLogger::initCommsTracer(int rank, int world_size) {
+  // number of records buffered between flushes, extra records are dropped
+  const size_t capacity = env_or("TORCH_UCC_COMMS_TRACE_BUFFER_SIZE", 65536);
+  const auto interval = std::chrono::milliseconds(
+      env_or("TORCH_UCC_COMMS_TRACE_FLUSH_MS", 1000));
+  static std::atomic<int> num_tracers{0};
+  // records are only queued if trace file can't be opened
+  trace_generator = std::make_shared<CommTraceLogger>(capacity);
+  initialized_CommTraceLogger = true;
+
+  trace_dirname = c10::str("ProcessGroupUCC_trace_np", world_size);
   time_t now_ = time(0);
   std::tm* ltm = localtime(&now_);
   if (ltm) {
-    dirname += c10::str(
+    trace_dirname += c10::str(
         "_",
         (1 + ltm->tm_mon),
         "_",
@@ -46,34 +55,126 @@ void ProcessGroupUCCLogger::flushComms(int rank, int world_size) {
         (1900 + ltm->tm_year));
   }
 
-  std::string fullpath = "/tmp/" + dirname;
+  std::string fullpath = "/tmp/" + trace_dirname;
   char* user_path = std::getenv("TORCH_UCC_COMMS_TRACE_OUTPUT_DIR");
   if (user_path) {
     fullpath = user_path;
   }
-  std::string trace_filename = c10::str(fullpath, "/rank", rank, ".json");
-  std::ofstream _outfile;
-  if (!_outfile.is_open()) {
-    if (!mkdir(fullpath.c_str(), 0777)) {
-      LOG(INFO) << getLogPrefix() << "[INFO] failed to mkdir " << fullpath;
-    } else if (errno != EEXIST) {
-      return;
-    }
-    _outfile.open(trace_filename, std::ofstream::out | std::ofstream::trunc);
+  if (mkdir(fullpath.c_str(), 0777) && errno != EEXIST) {
+    LOG(INFO) << getLogPrefix() << "[INFO] failed to mkdir " << fullpath;
+    return;
   }
-  // flush the traced comms
-  if (_outfile.is_open()) {
-    _outfile << "[" << c10::Join(",", trace_generator->getCommsTrace())
-             << "\n]";
-    _outfile.flush();
-    _outfile.close();
+  trace_filename =
+      c10::str(fullpath, "/rank", rank, "_", num_tracers++, ".bin");
+  if (!trace_generator->open(trace_filename, rank, world_size, interval)) {
+    LOG(INFO) << getLogPrefix() << "[INFO] failed to open "
+              << trace_filename;
+  }
+}
+
+void ProcessGroupUCCLogger::flushComms(int rank, int world_size) {
+  if (!initialized_CommTraceLogger) {
+    return;
+  }
+  trace_generator->close();
+  if (trace_generator->dropped()) {
+    LOG(WARNING) << getLogPrefix() << "dropped " << trace_generator->dropped()
+                 << " comms trace records, consider increasing "
+                 << "TORCH_UCC_COMMS_TRACE_BUFFER_SIZE";
   }
 #ifdef FBCODE_CAFFE2
   uploadTrace_internal(
-      trace_filename, dirname, c10::str("rank", rank, ".json"));
+      trace_filename,
+      trace_dirname,
+      trace_filename.substr(trace_filename.rfind('/') + 1));
 #endif
 }
 
+CommTraceLogger::CommTraceLogger(size_t capacity) : records_(capacity) {}
+
+CommTraceLogger::~CommTraceLogger() {
+  close();
+}
+
+bool CommTraceLogger::open(
+    const std::string& filename,
+    int rank,
+    int world_size,
+    std::chrono::milliseconds interval) {
+  file_ = fopen(filename.c_str(), "wb");
+  if (!file_) {
+    return false;
+  }
+  torch_ucc_trace_header_t header;
+  memcpy(header.magic, TORCH_UCC_TRACE_MAGIC, sizeof(header.magic));
+  header.version = TORCH_UCC_TRACE_VERSION;
+  header.record_size = sizeof(torch_ucc_trace_record_t);
+  header.rank = rank;
+  header.world_size = world_size;
+  fwrite(&header, sizeof(header), 1, file_);
+  flush_thread_ = std::thread(&CommTraceLogger::flushLoop, this, interval);
+  return true;
+}
+
+void CommTraceLogger::close() {
+  if (flush_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      stop_ = true;
+    }
+    flush_cv_.notify_all();
+    flush_thread_.join();
+  }
+  if (file_) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+void CommTraceLogger::flushLoop(std::chrono::milliseconds interval) {
+  std::unique_lock<std::mutex> lock(flush_mutex_);
+  while (!stop_) {
+    flush_cv_.wait_for(lock, interval, [this]() { return stop_; });
+    drain();
+  }
+}
+
+void CommTraceLogger::drain() {
+  torch_ucc_trace_record_t record;
+  while (records_.try_pop(record)) {
+    fwrite(&record, sizeof(record), 1, file_);
+  }
+  fflush(file_);
+}
+
+void CommTraceLogger::push(torch_ucc_trace_record_t& record) {
+  if (!records_.try_push(record)) {
+    dropped_++;
+  }
+}
+
+void CommTraceLogger::pushSplits(
+    torch_ucc_trace_record_type_t type,
+    uint64_t seq,
+    const std::vector<int64_t>& splits) {
+  for (size_t i = 0; i < splits.size();
+       i += TORCH_UCC_TRACE_SPLITS_PER_RECORD) {
+    torch_ucc_trace_record_t record;
+    record.type = type;
+    record.dtype = -1;
+    record.dev_type = -1;
+    record.root = -1;
+    record.seqnum = seq;
+    record.num_splits = (uint8_t)std::min<size_t>(
+        TORCH_UCC_TRACE_SPLITS_PER_RECORD, splits.size() - i);
+    std::copy(
+        splits.begin() + i,
+        splits.begin() + i + record.num_splits,
+        record.splits);
+    push(record);
+  }
+}
+
 /* unused */
 void CommTraceLogger::setCurBlock(const std::string& name) {
   curBlocks_.push_back(
@@ -118,53 +219,26 @@ void CommTraceLogger::recordComms(
 
   // TODO: get markers from torch profiler if enabled
 
-  // common fields for all operations
-  std::string cur_trace_ = c10::str(
-      "\n\t\t\"markers\": [",
-      curBlocks_,
-      "]",
-      ",\n\t\t\"startTime_ns\": ",
-      time_since_begin,
-      ",\n\t\t\"comms\": \"",
-      commName,
-      "\"",
-      ",\n\t\t\"req\": ",
-      workReq,
-      ",\n\t\t\"seqnum\": ",
-      seqnum++,
-      ",\n\t\t\"world_size\": ",
-      world_size);
-
-  if (inSize > 0 || outSize > 0) {
-    // for most collectives - append msg sizes, data type, device type
-    cur_trace_ = c10::str(
-        cur_trace_,
-        ",\n\t\t\"in_msg_size\": ",
-        inSize,
-        ",\n\t\t\"out_msg_size\": ",
-        outSize,
-        ",\n\t\t\"dtype\": \"",
-        at::toString(dtype),
-        "\",\n\t\t\"devType\": \"",
-        c10::DeviceTypeName(devType),
-        "\"");
-  }
-  if (curRoot_ != -1) {
-    // append root rank if applicable, e.g., broadcast, gather, scatter
-    cur_trace_ = c10::str(cur_trace_, ",\n\t\t\"root\": ", curRoot_);
-  }
-  if (curInSplitSizes_.size() > 0 || curOutSplitSizes_.size() > 0) {
-    // append input and output splits if applicable, e.g., ALLTOALL_BASE
-    cur_trace_ = c10::str(
-        cur_trace_,
-        ",\n\t\t\"in_split\": [",
-        c10::Join(",", curInSplitSizes_),
-        "]"
-        ",\n\t\t\"out_split\": [",
-        c10::Join(",", curOutSplitSizes_),
-        "]");
-  }
-  comms_trace_.push_back(c10::str("\n\t{", cur_trace_, "\n\t}"));
+  torch_ucc_trace_record_t record;
+  record.type = TORCH_UCC_TRACE_COMM;
+  record.dtype = (inSize > 0 || outSize > 0) ? (int8_t)dtype : -1;
+  record.dev_type = (inSize > 0 || outSize > 0) ? (int8_t)devType : -1;
+  record.num_splits = 0;
+  // root rank if applicable, e.g., broadcast, gather, scatter
+  record.root = curRoot_;
+  record.seqnum = seqnum++;
+  record.comm.start_ns = time_since_begin;
+  record.comm.req = workReq;
+  record.comm.in_size = inSize;
+  record.comm.out_size = outSize;
+  record.comm.world_size = world_size;
+  record.comm.reserved = 0;
+  strncpy(record.comm.name, commName.c_str(), TORCH_UCC_TRACE_NAME_LEN - 1);
+  record.comm.name[TORCH_UCC_TRACE_NAME_LEN - 1] = '\0';
+  push(record);
+  // input and output splits if applicable, e.g., ALLTOALL_BASE
+  pushSplits(TORCH_UCC_TRACE_IN_SPLIT, record.seqnum, curInSplitSizes_);
+  pushSplits(TORCH_UCC_TRACE_OUT_SPLIT, record.seqnum, curOutSplitSizes_);
 
   // record the trace to kineto trace if applicable
   RECORD_PARAM_COMMS(
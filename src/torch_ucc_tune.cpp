@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ */
+
+#include "torch_ucc_tune.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+namespace c10d {
+
+namespace {
+
+// Tuning file holds one line per tuned key and operation:
+//   <key> <operation> <choice of every size bucket, '-' if untuned>
+// lines starting with '#' are comments.
+constexpr char kUntuned = '-';
+
+bool parse_op(const std::string& name, torch_ucc_tune_op_t& op) {
+  for (int i = 0; i < TORCH_UCC_TUNE_LAST; i++) {
+    if (name == torch_ucc_tune_op_name((torch_ucc_tune_op_t)i)) {
+      op = (torch_ucc_tune_op_t)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string format_row(const ProcessGroupUCCTuneTable::Row& row) {
+  std::string s(row.size(), kUntuned);
+  for (size_t b = 0; b < row.size(); b++) {
+    if (row[b] >= 0) {
+      s[b] = '0' + row[b];
+    }
+  }
+  return s;
+}
+
+} // namespace
+
+const char* torch_ucc_tune_op_name(torch_ucc_tune_op_t op) {
+  switch (op) {
+    case TORCH_UCC_TUNE_ALLGATHER:
+      return "allgather";
+    case TORCH_UCC_TUNE_CHUNKING:
+      return "chunking";
+    case TORCH_UCC_TUNE_HIER:
+      return "hier";
+    default:
+      return "unknown";
+  }
+}
+
+ProcessGroupUCCTuneTable::ProcessGroupUCCTuneTable() {
+  for (auto& rows : rows_) {
+    for (auto& row : rows) {
+      row.fill(-1);
+    }
+  }
+  for (int d = 0; d < 2; d++) {
+    started_[d] = false;
+    ready_[d] = false;
+  }
+}
+
+void ProcessGroupUCCTuneTable::set_rows(c10::DeviceType dev, const Rows& rows) {
+  const int d = device_index(dev);
+  rows_[d] = rows;
+  ready_[d].store(true, std::memory_order_release);
+}
+
+bool ProcessGroupUCCTuneTable::load(
+    const std::string& path,
+    const std::string& key,
+    Rows& rows) {
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  bool found = false;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string line_key, name, choices;
+    torch_ucc_tune_op_t op;
+    if (line.empty() || line[0] == '#' ||
+        !(fields >> line_key >> name >> choices) || line_key != key) {
+      continue;
+    }
+    if (!parse_op(name, op)) {
+      // operation no longer tuned
+      continue;
+    }
+    if (choices.size() != (size_t)kBuckets) {
+      throw std::invalid_argument(
+          "malformed line in tuning file " + path + ": " + line);
+    }
+    for (int b = 0; b < kBuckets; b++) {
+      const char c = choices[b];
+      if (c != kUntuned && (c < '0' || c > '9')) {
+        throw std::invalid_argument(
+            "malformed line in tuning file " + path + ": " + line);
+      }
+      rows[op][b] = c == kUntuned ? -1 : c - '0';
+    }
+    found = true;
+  }
+  return found;
+}
+
+void ProcessGroupUCCTuneTable::save(
+    const std::string& path,
+    const std::string& key,
+    const Rows& rows) {
+  std::vector<std::string> kept;
+  {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream fields(line);
+      std::string line_key;
+      if (line.empty() || line[0] == '#' || !(fields >> line_key) ||
+          line_key != key) {
+        kept.push_back(line);
+      }
+    }
+  }
+  if (kept.empty()) {
+    kept.push_back(
+        "# torch_ucc tuning table: key, operation, choice per size bucket");
+  }
+  // written aside and renamed, concurrent readers see old or new table
+  const std::string tmp = path + "." + std::to_string(getpid());
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("failed to write tuning file " + tmp);
+    }
+    for (const auto& line : kept) {
+      out << line << "\n";
+    }
+    for (int op = 0; op < TORCH_UCC_TUNE_LAST; op++) {
+      out << key << " " << torch_ucc_tune_op_name((torch_ucc_tune_op_t)op)
+          << " " << format_row(rows[op]) << "\n";
+    }
+    if (!out) {
+      throw std::runtime_error("failed to write tuning file " + tmp);
+    }
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    throw std::runtime_error("failed to replace tuning file " + path);
+  }
+}
+
+} // namespace c10d
@@ -31,5 +31,19 @@ for count in counts:
     status = check_tensor_list_equal(tensors_out_ucc, tensors_out_test)
     dist.all_reduce(status, group=pg)
     print_test_result(status, count, comm_rank, comm_size)
+
+print_test_head("Allgather into chunks of one buffer", comm_rank)
+for count in counts:
+    tensor_input = get_tensor(count, args.use_cuda)
+    flat_out_ucc = get_tensor(count * comm_size, args.use_cuda)
+    tensors_out_ucc = list(flat_out_ucc.chunk(comm_size))
+    tensors_out_test = []
+    for p in range(comm_size):
+        tensors_out_test.append(get_tensor(count, is_cuda=False))
+    dist.all_gather(tensors_out_ucc, tensor_input)
+    dist.all_gather(tensors_out_test, tensor_input.cpu(), group=pg)
+    status = check_tensor_list_equal(tensors_out_ucc, tensors_out_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
 if comm_rank == 0:
     print("Test allgather: succeeded")
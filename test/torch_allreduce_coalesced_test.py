@@ -0,0 +1,37 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+counts = 2 ** np.arange(12)
+print_test_head("Allreduce coalesced", comm_rank)
+for num_tensors in [1, 4, 64]:
+    for count in counts:
+        # mixed sizes so tensors land at unaligned offsets of the flat buffer
+        tensors_ucc = [
+            get_tensor(int(count) + i, args.use_cuda) for i in range(num_tensors)
+        ]
+        tensors_test = [t.cpu() for t in tensors_ucc]
+        dist.all_reduce_coalesced(tensors_ucc)
+        status = torch.tensor(1, device=tensors_test[0].device)
+        for t_ucc, t_test in zip(tensors_ucc, tensors_test):
+            dist.all_reduce(t_test, group=pg)
+            status = status * check_tensor_equal(t_ucc, t_test)
+        dist.all_reduce(status, group=pg)
+        print_test_result(
+            status, "{} x {}".format(num_tensors, count), comm_rank, comm_size
+        )
+
+if comm_rank == 0:
+    print("Test allreduce coalesced: succeeded")
@@ -0,0 +1,76 @@
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+ucc_pg = dist.new_group(backend="ucc")
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+row = 3
+
+
+def random_splits(seed, count):
+    np.random.seed(seed)
+    return np.random.randint(
+        low=0, high=2 * count // comm_size + 1, size=(comm_size, comm_size)
+    )
+
+
+def reference(send_tensor, split):
+    recv_tensor = torch.empty(
+        (int(np.sum(split[:, comm_rank])), row), dtype=send_tensor.dtype)
+    dist.all_to_all_single(
+        recv_tensor,
+        send_tensor.cpu(),
+        split[:, comm_rank].tolist(),
+        split[comm_rank, :].tolist(),
+        group=pg,
+    )
+    return recv_tensor
+
+
+counts = 2 ** np.arange(4, 16, 3)
+
+# same splits again and again hit the cached displacements
+print_test_head("Alltoallv repeated splits", comm_rank)
+for count in counts:
+    split = random_splits(count, count)
+    for it in range(4):
+        send_tensor = get_tensor(int(np.sum(split[comm_rank, :])) * row,
+                                 args.use_cuda).view(-1, row)
+        recv_tensor = torch.empty(
+            (int(np.sum(split[:, comm_rank])), row), dtype=send_tensor.dtype,
+            device=send_tensor.device)
+        dist.all_to_all_single(
+            recv_tensor, send_tensor,
+            split[:, comm_rank].tolist(), split[comm_rank, :].tolist(),
+            group=ucc_pg)
+        status = check_tensor_equal(recv_tensor, reference(send_tensor, split))
+        dist.all_reduce(status, group=pg)
+        print_test_result(status, "{}[{}]".format(count, it), comm_rank,
+                          comm_size)
+
+print_test_head("Alltoall with splits exchange", comm_rank)
+for count in counts:
+    split = random_splits(count + 1, count)
+    send_tensor = get_tensor(int(np.sum(split[comm_rank, :])) * row,
+                             args.use_cuda).view(-1, row)
+    work, recv_tensor, recv_splits = torch_ucc.alltoall_with_splits(
+        ucc_pg, send_tensor, split[comm_rank, :].tolist())
+    work.wait()
+    status = check_tensor_equal(recv_tensor, reference(send_tensor, split))
+    if recv_splits != split[:, comm_rank].tolist():
+        status = torch.tensor(0, device=status.device)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+if comm_rank == 0:
+    print("Test alltoall splits: succeeded")
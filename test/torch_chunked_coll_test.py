@@ -0,0 +1,49 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import os
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+# chunking applies to CUDA tensors only, must be set before the first PG
+os.environ.setdefault("TORCH_UCC_CHUNK_SIZE", "65536")
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+counts = 2 ** np.arange(10, 24, 3)
+print_test_head("Chunked allreduce", comm_rank)
+for count in counts:
+    tensor_ucc = get_tensor(int(count) + 3, args.use_cuda)
+    tensor_test = tensor_ucc.cpu()
+    work = dist.all_reduce(tensor_ucc, async_op=True)
+    if args.use_cuda:
+        # consume chunks as soon as they land
+        for i in range(torch_ucc.work_num_chunks(work)):
+            torch_ucc.wait_chunk(work, i)
+    work.wait()
+    dist.all_reduce(tensor_test, group=pg)
+    status = check_tensor_equal(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+print_test_head("Chunked broadcast", comm_rank)
+for count in counts:
+    tensor_ucc = get_tensor(int(count) + 3, args.use_cuda)
+    tensor_test = tensor_ucc.cpu()
+    dist.broadcast(tensor_ucc, 0)
+    dist.broadcast(tensor_test, 0, group=pg)
+    status = check_tensor_equal(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+if comm_rank == 0:
+    print("Test chunked collectives: succeeded")
@@ -0,0 +1,77 @@
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import os
+import sys
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+# compression applies to float32 CUDA tensors only, must be set before the
+# first PG
+os.environ.setdefault("TORCH_UCC_COMPRESSION", "bf16")
+os.environ.setdefault("TORCH_UCC_COMPRESSION_ERROR_FEEDBACK", "1")
+
+args = parse_test_args()
+if not args.use_cuda:
+    print("Compression test requires --use-cuda")
+    sys.exit(0)
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+# relative error of a single bf16 rounding, fp16 is more precise
+rtol = 2 ** -7 * comm_size
+
+
+def check_close(t_ucc, t_pg):
+    if torch.allclose(t_ucc.cpu(), t_pg, rtol=rtol, atol=1e-3):
+        return torch.tensor(1, device=t_pg.device)
+    print("failed on rank {}".format(comm_rank))
+    return torch.tensor(0, device=t_pg.device)
+
+
+counts = 2 ** np.arange(4, 20, 3)
+print_test_head("Compressed allreduce", comm_rank)
+for count in counts:
+    tensor_ucc = torch.rand(count, device="cuda")
+    tensor_test = tensor_ucc.cpu()
+    dist.all_reduce(tensor_ucc)
+    dist.all_reduce(tensor_test, group=pg)
+    status = check_close(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+print_test_head("Compressed reduce_scatter", comm_rank)
+for count in counts:
+    inputs_ucc = [torch.rand(count, device="cuda") for _ in range(comm_size)]
+    inputs_test = [t.cpu() for t in inputs_ucc]
+    output_ucc = torch.empty(count, device="cuda")
+    output_test = torch.empty(count)
+    dist.reduce_scatter(output_ucc, inputs_ucc)
+    # no reduce_scatter on the checking PG, reduce every chunk instead
+    for i, t in enumerate(inputs_test):
+        dist.all_reduce(t, group=pg)
+        if i == comm_rank:
+            output_test.copy_(t)
+    status = check_close(output_ucc, output_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+# same bucket on every iteration carries its rounding error over
+print_test_head("Compressed allreduce with error feedback", comm_rank)
+for count in counts:
+    bucket = torch.rand(count, device="cuda")
+    for it in range(3):
+        tensor_test = bucket.cpu()
+        torch_ucc.set_compression_bucket(int(count))
+        dist.all_reduce(bucket)
+        dist.all_reduce(tensor_test, group=pg)
+        status = check_close(bucket, tensor_test)
+        dist.all_reduce(status, group=pg)
+        print_test_result(status, "{} iter {}".format(count, it), comm_rank, comm_size)
+        bucket /= comm_size
@@ -0,0 +1,57 @@
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import sys
+
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+if not args.use_cuda:
+    print("CUDA graph test requires --use-cuda")
+    sys.exit(0)
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+
+def capture(g, fn):
+    # progress thread of eager operations must not invalidate the capture
+    try:
+        ctx = torch.cuda.graph(g, capture_error_mode="thread_local")
+    except TypeError:
+        ctx = torch.cuda.graph(g)
+    with ctx:
+        fn()
+
+
+counts = [16, 1024, 65536]
+print_test_head("CUDA graph allreduce", comm_rank)
+for count in counts:
+    tensor = torch.zeros(count, device="cuda")
+    # warm up on a side stream, creates the team and the capture events
+    side = torch.cuda.Stream()
+    side.wait_stream(torch.cuda.current_stream())
+    with torch.cuda.stream(side):
+        dist.all_reduce(tensor)
+    torch.cuda.current_stream().wait_stream(side)
+    torch.cuda.synchronize()
+
+    g = torch.cuda.CUDAGraph()
+    capture(g, lambda: dist.all_reduce(tensor).wait())
+    status = torch.tensor(1, device="cuda")
+    for replay in range(3):
+        tensor.fill_(comm_rank + replay)
+        g.replay()
+        expected = sum(r + replay for r in range(comm_size))
+        if not torch.all(tensor == expected).item():
+            print("failed on rank {} replay {}".format(comm_rank, replay))
+            status = torch.tensor(0, device="cuda")
+    # eager collective after capture completes the captured requests on host
+    dist.all_reduce(tensor)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
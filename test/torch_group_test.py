@@ -0,0 +1,54 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+counts = 2 ** np.arange(16)
+num_peers_ops = 8
+print_test_head("Grouped operations", comm_rank)
+dst = (comm_rank + 1) % comm_size
+src = (comm_rank - 1 + comm_size) % comm_size
+for count in counts:
+    send_ucc = [get_tensor(count, args.use_cuda) for _ in range(num_peers_ops)]
+    recv_ucc = [torch.zeros_like(t) for t in send_ucc]
+    ar_ucc = get_tensor(count, args.use_cuda)
+    send_test = [t.cpu() for t in send_ucc]
+    recv_test = [t.cpu() for t in recv_ucc]
+    ar_test = ar_ucc.cpu()
+
+    # ring exchange and allreduce submitted as a single batch
+    torch_ucc.group_start()
+    for i in range(num_peers_ops):
+        dist.isend(send_ucc[i], dst=dst, tag=i)
+        dist.irecv(recv_ucc[i], src=src, tag=i)
+    dist.all_reduce(ar_ucc, async_op=True)
+    work = torch_ucc.group_end()
+    work.wait()
+
+    reqs = []
+    for i in range(num_peers_ops):
+        reqs.append(dist.isend(send_test[i], dst=dst, tag=i, group=pg))
+        reqs.append(dist.irecv(recv_test[i], src=src, tag=i, group=pg))
+    for req in reqs:
+        req.wait()
+    dist.all_reduce(ar_test, group=pg)
+
+    status = check_tensor_equal(ar_ucc, ar_test)
+    for t_ucc, t_test in zip(recv_ucc, recv_test):
+        status = status * check_tensor_equal(t_ucc, t_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+if comm_rank == 0:
+    print("Test grouped operations: succeeded")
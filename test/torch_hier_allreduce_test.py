@@ -0,0 +1,38 @@
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import os
+import sys
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+# split ranks of a single host into nodes of 2, hierarchical allreduce
+# applies to CUDA tensors only, must be set before the first PG
+os.environ.setdefault("TORCH_UCC_HIER_ALLREDUCE_THRESHOLD", "4096")
+os.environ.setdefault("TORCH_UCC_HIER_LOCAL_SIZE", "2")
+
+args = parse_test_args()
+if not args.use_cuda:
+    print("Hierarchical allreduce test requires --use-cuda")
+    sys.exit(0)
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+# sizes below and above threshold, odd counts need padding to local size
+counts = [int(c) + d for c in 2 ** np.arange(8, 20, 3) for d in (0, 3)]
+print_test_head("Hierarchical allreduce", comm_rank)
+for count in counts:
+    tensor_ucc = get_tensor(count, args.use_cuda)
+    tensor_test = tensor_ucc.cpu()
+    dist.all_reduce(tensor_ucc)
+    dist.all_reduce(tensor_test, group=pg)
+    status = check_tensor_equal(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
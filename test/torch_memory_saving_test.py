@@ -0,0 +1,63 @@
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import os
+import sys
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+# read by the first UCC process group
+os.environ.setdefault("TORCH_UCC_MEMORY_SAVING", "1")
+pool_size = int(os.environ.setdefault("TORCH_UCC_BUFFER_POOL_SIZE", "65536"))
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+ucc_pg = dist.new_group(backend="ucc")
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+counts = 2 ** np.arange(4, 20, 3)
+
+# same sizes twice, second round runs on pooled buffers
+print_test_head("Pooled allgather", comm_rank)
+for count in np.concatenate([counts, counts]):
+    send_tensor = get_tensor(count, args.use_cuda)
+    recv_ucc = [get_tensor(count, args.use_cuda) for _ in range(comm_size)]
+    recv_test = [get_tensor(count, is_cuda=False) for _ in range(comm_size)]
+    dist.all_gather(recv_ucc, send_tensor, group=ucc_pg)
+    dist.all_gather(recv_test, send_tensor.cpu(), group=pg)
+    status = torch.tensor(1, device=send_tensor.device)
+    for t_ucc, t_test in zip(recv_ucc, recv_test):
+        status = status * check_tensor_equal(t_ucc, t_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+# fused through a pooled flat buffer, larger ones exceed the pool limit
+print_test_head("Pooled allreduce coalesced", comm_rank)
+for count in np.concatenate([counts, counts]):
+    tensors_ucc = [get_tensor(int(count) + i, args.use_cuda) for i in range(4)]
+    tensors_test = [t.cpu() for t in tensors_ucc]
+    dist.all_reduce_coalesced(tensors_ucc, group=ucc_pg)
+    status = torch.tensor(1, device=tensors_test[0].device)
+    for t_ucc, t_test in zip(tensors_ucc, tensors_test):
+        dist.all_reduce(t_test, group=pg)
+        status = status * check_tensor_equal(t_ucc, t_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, "4 x {}".format(count), comm_rank, comm_size)
+
+cached = torch_ucc.buffer_pool_bytes(ucc_pg)
+status = torch.tensor(1 if cached <= pool_size else 0)
+dist.all_reduce(status, group=pg)
+if status.item() != comm_size:
+    if comm_rank == 0:
+        print("Test memory saving failed: pool keeps {} bytes, limit {}".format(
+            cached, pool_size))
+    sys.exit(1)
+if comm_rank == 0:
+    print("Test memory saving: succeeded")
@@ -0,0 +1,50 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import sys
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+ucc_pg = dist.new_group(backend="ucc")
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+print_test_head("Metrics", comm_rank)
+torch_ucc.reset_metrics(ucc_pg)
+counts = [16, 1024, 65536]
+num_iters = 4
+# CPU only, CUDA works may complete before progress thread records them
+for count in counts:
+    for _ in range(num_iters):
+        t = get_tensor(count, False)
+        dist.all_reduce(t, group=ucc_pg).wait()
+
+metrics = torch_ucc.get_metrics(ucc_pg)
+allreduce = [m for m in metrics if m["op"] == "ALLREDUCE"]
+status = torch.tensor(1)
+# every count falls into its own size bucket
+if sorted(m["count"] for m in allreduce) != [num_iters] * len(counts):
+    status = torch.tensor(0)
+for m in allreduce:
+    if sum(m["latency_hist"]) != m["count"] or m["bytes"] <= 0:
+        status = torch.tensor(0)
+    if m["max_us"] <= 0 or m["avg_inflight_us"] < 0:
+        status = torch.tensor(0)
+
+torch_ucc.reset_metrics(ucc_pg)
+if torch_ucc.get_metrics(ucc_pg):
+    status = torch.tensor(0)
+
+dist.all_reduce(status, group=pg)
+if status.item() != comm_size:
+    if comm_rank == 0:
+        print("Test Failed")
+    sys.exit(1)
+if comm_rank == 0:
+    print("Test metrics: succeeded")
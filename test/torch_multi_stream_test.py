@@ -0,0 +1,54 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+# every group has its own internal stream, collectives of different groups
+# may run concurrently
+groups = [dist.new_group(backend="ucc") for _ in range(2)]
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+counts = 2 ** np.arange(4, 20, 3)
+num_inflight = 8
+print_test_head("Concurrent allreduce on two groups", comm_rank)
+for count in counts:
+    tensors_ucc = [get_tensor(count, args.use_cuda) for _ in range(num_inflight)]
+    tensors_test = [t.cpu() for t in tensors_ucc]
+    works = [
+        dist.all_reduce(t, group=groups[i % 2], async_op=True)
+        for i, t in enumerate(tensors_ucc)
+    ]
+    for work in works:
+        work.wait()
+    status = torch.tensor(1, device=tensors_test[0].device)
+    for t_ucc, t_test in zip(tensors_ucc, tensors_test):
+        dist.all_reduce(t_test, group=pg)
+        status = status * check_tensor_equal(t_ucc, t_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+# async collectives of one group on the same tensor run in issue order
+print_test_head("Ordered allreduce and broadcast", comm_rank)
+for count in counts:
+    tensor_ucc = get_tensor(count, args.use_cuda)
+    tensor_test = tensor_ucc.cpu()
+    work = dist.all_reduce(tensor_ucc, group=groups[0], async_op=True)
+    dist.broadcast(tensor_ucc, 0, group=groups[0])
+    work.wait()
+    dist.all_reduce(tensor_test, group=pg)
+    dist.broadcast(tensor_test, 0, group=pg)
+    status = check_tensor_equal(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+if comm_rank == 0:
+    print("Test multiple streams: succeeded")
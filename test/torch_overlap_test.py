@@ -0,0 +1,51 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+# second UCC group sharing the same progress engine when TORCH_UCC_SHARED_COMM=1
+ucc_pg = dist.new_group(backend="ucc")
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+print_test_head("Overlapping requests", comm_rank)
+big_count = 2 ** 22
+small_count = 4
+num_small = 16
+
+send_big = get_tensor(big_count * comm_size, args.use_cuda)
+recv_big = get_tensor(big_count * comm_size, args.use_cuda)
+big_work = dist.all_to_all_single(recv_big, send_big, async_op=True)
+
+small_ucc = [get_tensor(small_count, args.use_cuda) for _ in range(num_small)]
+small_test = [t.cpu() for t in small_ucc]
+small_works = [
+    dist.all_reduce(t, group=ucc_pg, async_op=True) for t in small_ucc
+]
+# requests are finalized in completion order, waiting on the small ones first
+# must not depend on the large alltoall posted ahead of them
+for w in reversed(small_works):
+    w.wait()
+big_work.wait()
+
+for t in small_test:
+    dist.all_reduce(t, group=pg)
+status = check_tensor_list_equal(small_ucc, small_test)
+dist.all_reduce(status, group=pg)
+print_test_result(status, "{} x {}".format(small_count, num_small), comm_rank, comm_size)
+
+recv_test = torch.empty_like(recv_big, device="cpu")
+dist.all_to_all_single(recv_test, send_big.cpu(), group=pg)
+status = check_tensor_equal(recv_big, recv_test)
+dist.all_reduce(status, group=pg)
+print_test_result(status, big_count, comm_rank, comm_size)
+
+if comm_rank == 0:
+    print("Test overlapping requests: succeeded")
@@ -0,0 +1,75 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+ucc_pg = dist.new_group(backend="ucc")
+torch_ucc.set_persistent_collectives(ucc_pg, True)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+print_test_head("Persistent allreduce", comm_rank)
+count = 1024
+num_iters = 8
+# same buffer, count, dtype and op on every iteration reposts cached request
+tensor_ucc = get_tensor(count, args.use_cuda)
+for it in range(num_iters):
+    tensor_ucc.copy_(get_tensor(count, args.use_cuda))
+    tensor_test = tensor_ucc.cpu()
+    dist.all_reduce(tensor_ucc, group=ucc_pg)
+    dist.all_reduce(tensor_test, group=pg)
+    status = check_tensor_equal(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, "{} iter {}".format(count, it), comm_rank, comm_size)
+
+# more distinct buffers than cache entries, least recently used are evicted
+print_test_head("Persistent eviction", comm_rank)
+for it in range(80):
+    tensor_ucc = get_tensor(count + it, args.use_cuda)
+    tensor_test = tensor_ucc.cpu()
+    dist.all_reduce(tensor_ucc, group=ucc_pg)
+    dist.all_reduce(tensor_test, group=pg)
+    status = check_tensor_equal(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, "{} iter {}".format(count + it, it), comm_rank, comm_size)
+
+# second collective on the same buffer while the first may be in flight
+print_test_head("Persistent overlapping", comm_rank)
+tensor_ucc = get_tensor(count, args.use_cuda)
+tensor_test = tensor_ucc.cpu()
+works = [dist.all_reduce(tensor_ucc, group=ucc_pg, async_op=True) for _ in range(2)]
+for work in works:
+    work.wait()
+for _ in range(2):
+    dist.all_reduce(tensor_test, group=pg)
+status = check_tensor_equal(tensor_ucc, tensor_test)
+dist.all_reduce(status, group=pg)
+print_test_result(status, count, comm_rank, comm_size)
+
+if args.use_cuda:
+    # released segments drop cached requests, a new buffer at the same
+    # address gets a fresh request
+    print_test_head("Persistent released buffer", comm_rank)
+    for it in range(4):
+        tensor_ucc = get_tensor(count, args.use_cuda)
+        tensor_test = tensor_ucc.cpu()
+        dist.all_reduce(tensor_ucc, group=ucc_pg)
+        dist.all_reduce(tensor_test, group=pg)
+        status = check_tensor_equal(tensor_ucc, tensor_test)
+        dist.all_reduce(status, group=pg)
+        print_test_result(status, "iter {}".format(it), comm_rank, comm_size)
+        del tensor_ucc
+        torch.cuda.empty_cache()
+
+torch_ucc.clear_persistent_collectives(ucc_pg)
+torch_ucc.set_persistent_collectives(ucc_pg, False)
+
+if comm_rank == 0:
+    print("Test persistent allreduce: succeeded")
@@ -31,5 +31,17 @@ for count in counts:
     dist.all_reduce(status, group=pg)
     print_test_result(status, count, comm_rank, comm_size)
 
+print_test_head("Reduce_scatter from chunks of one buffer", comm_rank)
+for count in counts:
+    flat_input = get_tensor(count * comm_size, args.use_cuda)
+    tensors_input = list(flat_input.chunk(comm_size))
+    tensor_ucc = get_tensor(count, args.use_cuda)
+    tensor_test = tensor_ucc.cpu()
+    dist.reduce_scatter(tensor_ucc, tensors_input)
+    dist.reduce_scatter(tensor_test, [t.cpu() for t in tensors_input], group=pg)
+    status = check_tensor_equal(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
 if comm_rank == 0:
     print("Test reduce_scatter: succeeded")
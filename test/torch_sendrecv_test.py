@@ -36,3 +36,15 @@ if comm_rank == 1:
     print("recv before: ", t)
     dist.recv(t, 0, tag=128)
     print("recv after: ", t)
+
+# receive from any source reports actual sender
+if comm_rank == 0:
+    t = torch.full([16], comm_rank + 1)
+    dist.send(t, 1, tag=256)
+if comm_rank == 1:
+    t = torch.full([16], 0)
+    src = dist.recv(t, tag=256)
+    print("recv any source from: ", src)
+    if src != 0 or not torch.all(t == 1):
+        print("Test Failed")
+        sys.exit(1)
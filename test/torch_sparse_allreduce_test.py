@@ -0,0 +1,64 @@
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import sys
+
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+device = torch.device("cuda") if args.use_cuda else torch.device("cpu")
+
+
+def row_sparse(rows, dim, nnz):
+    # embedding gradient like, duplicate rows within and across ranks
+    indices = torch.randint(0, rows, (1, nnz))
+    values = torch.randint(0, 100, (nnz, dim), dtype=torch.float32)
+    return torch.sparse_coo_tensor(indices, values, (rows, dim))
+
+
+def coo(shape, nnz):
+    indices = torch.stack([torch.randint(0, n, (nnz,)) for n in shape])
+    values = torch.randint(0, 100, (nnz,), dtype=torch.float32)
+    return torch.sparse_coo_tensor(indices, values, shape)
+
+
+print_test_head("Sparse allreduce", comm_rank)
+cases = [
+    ("row sparse", lambda: row_sparse(1000, 16, 64 * (comm_rank + 1))),
+    ("row sparse empty", lambda: row_sparse(1000, 8, 0 if comm_rank % 2 else 32)),
+    ("coo", lambda: coo((64, 64, 8), 128)),
+]
+for name, make in cases:
+    t = make()
+    expected = t.to_dense()
+    dist.all_reduce(expected, group=pg)
+    t_ucc = t.to(device)
+    dist.all_reduce(t_ucc)
+    status = check_tensor_equal(t_ucc.to_dense(), expected)
+    if not t_ucc.is_coalesced():
+        print("result not coalesced on rank {}".format(comm_rank))
+        status = torch.tensor(0)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, name, comm_rank, comm_size)
+
+# merge finishes on the progress thread, the work covers it
+t = row_sparse(1000, 16, 64)
+expected = t.to_dense()
+dist.all_reduce(expected, group=pg)
+t_ucc = t.to(device)
+req = dist.all_reduce(t_ucc, async_op=True)
+req.wait()
+status = check_tensor_equal(t_ucc.to_dense(), expected)
+dist.all_reduce(status, group=pg)
+print_test_result(status, "async wait", comm_rank, comm_size)
+
+if comm_rank == 0:
+    print("Test sparse allreduce: succeeded")
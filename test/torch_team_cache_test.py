@@ -0,0 +1,47 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+# groups over the same ranks share one team with TORCH_UCC_TEAM_CACHE=1
+num_groups = 4
+groups = [dist.new_group(backend="ucc") for _ in range(num_groups)]
+# group over a subset of ranks uses its own team
+half = dist.new_group(ranks=list(range(max(comm_size // 2, 1))), backend="ucc")
+
+counts = 2 ** np.arange(12)
+print_test_head("Team cache", comm_rank)
+for count in counts:
+    status = torch.tensor(1)
+    for group in groups + [None]:
+        t_ucc = get_tensor(count, args.use_cuda)
+        t_test = t_ucc.cpu()
+        dist.all_reduce(t_ucc, group=group)
+        dist.all_reduce(t_test, group=pg)
+        status = status * check_tensor_equal(t_ucc, t_test)
+    if comm_rank < max(comm_size // 2, 1):
+        t_ucc = get_tensor(count, args.use_cuda)
+        dist.all_reduce(t_ucc, group=half)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+# release some of the references and recreate groups
+for group in groups[:2]:
+    dist.destroy_process_group(group)
+groups = groups[2:] + [dist.new_group(backend="ucc")]
+for group in groups:
+    group.barrier()
+
+if comm_rank == 0:
+    print("Test team cache: succeeded")
@@ -0,0 +1,82 @@
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import os
+import sys
+import tempfile
+
+import numpy as np
+from torch_ucc_test_setup import *
+
+# read by the first UCC process group
+tune_file = os.environ.setdefault(
+    "TORCH_UCC_TUNE_FILE",
+    os.path.join(tempfile.gettempdir(), "torch_ucc_tune_test.table"))
+os.environ.setdefault("TORCH_UCC_TUNE_MAX_SIZE", str(2 ** 18))
+# CPU allreduce has candidates only with helper communicators
+os.environ.setdefault("TORCH_UCC_CPU_HELPERS", "1")
+os.environ.setdefault("TORCH_UCC_CPU_SHARD_SIZE", "4096")
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+ucc_pg = dist.new_group(backend="ucc")
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+device = torch.device("cuda") if args.use_cuda else torch.device("cpu")
+
+
+def tuning_choices(group):
+    return [(m["device"], m["op"], m["size_bucket"], m["choice"])
+            for m in torch_ucc.get_tuning(group) if m["device"] == device.type]
+
+
+def check(ok, what):
+    status = torch.tensor(1 if ok else 0)
+    dist.all_reduce(status, group=pg)
+    if status.item() != comm_size:
+        if comm_rank == 0:
+            print("Test tuning failed: {}".format(what))
+        sys.exit(1)
+
+
+print_test_head("Tuning", comm_rank)
+torch_ucc.tune(ucc_pg, device)
+tuned = tuning_choices(ucc_pg)
+check(any(op == "chunking" for _, op, _, _ in tuned), "no chunking choices")
+
+# every rank must take the same paths
+choices = torch.tensor([c for _, _, _, c in tuned])
+summed = choices.clone()
+dist.all_reduce(summed, group=pg)
+check(torch.equal(summed, choices * comm_size), "ranks disagree")
+
+if comm_rank == 0:
+    with open(tune_file) as f:
+        saved = f.read()
+    check("chunking" in saved, "table not saved")
+else:
+    check(True, "table not saved")
+
+# new group loads the table on its first collective
+reload_pg = dist.new_group(backend="ucc")
+dist.all_reduce(get_tensor(1, args.use_cuda), group=reload_pg)
+check(tuning_choices(reload_pg) == tuned, "table not reloaded")
+
+counts = 2 ** np.arange(4, 20, 3)
+print_test_head("Tuned allreduce", comm_rank)
+for count in counts:
+    tensor_ucc = get_tensor(count, args.use_cuda)
+    tensor_test = tensor_ucc.cpu()
+    dist.all_reduce(tensor_ucc, group=ucc_pg)
+    dist.all_reduce(tensor_test, group=pg)
+    status = check_tensor_equal(tensor_ucc, tensor_test)
+    dist.all_reduce(status, group=pg)
+    print_test_result(status, count, comm_rank, comm_size)
+
+if comm_rank == 0:
+    print("Test tuning: succeeded")
@@ -0,0 +1,101 @@
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+# Sweeps message sizes of ProcessGroupUCC operations with the native timing
+# loop torch_ucc.bench and prints latency percentiles and bus bandwidth of the
+# slowest rank, in nccl-tests like format. Run with start_test.sh or mpirun.
+
+import argparse
+import os
+import sys
+
+import torch
+import torch.distributed as dist
+
+import torch_ucc
+
+parser = argparse.ArgumentParser(description="ProcessGroupUCC Benchmark")
+parser.add_argument("--ops", type=str, default=",".join(torch_ucc.bench_ops()),
+                    help="comma separated operations: " + ",".join(torch_ucc.bench_ops()))
+parser.add_argument("--use-cuda", default=False, action="store_true")
+parser.add_argument("--min-size", type=int, default=2 ** 3)
+parser.add_argument("--max-size", type=int, default=2 ** 22)
+parser.add_argument("--warmup", type=int, default=10)
+parser.add_argument("--iters", type=int, default=100)
+args = parser.parse_args()
+
+try:
+    comm_size = int(os.environ["OMPI_COMM_WORLD_SIZE"])
+    comm_rank = int(os.environ["OMPI_COMM_WORLD_RANK"])
+    local_rank = int(os.environ["OMPI_COMM_WORLD_LOCAL_RANK"])
+except:
+    print("OMPI env variables are not found")
+    sys.exit(1)
+
+if args.use_cuda and not torch.cuda.is_available():
+    print("CUDA is not available")
+    sys.exit(0)
+
+os.environ.setdefault("MASTER_PORT", "32167")
+os.environ.setdefault("MASTER_ADDR", "localhost")
+os.environ["RANK"] = str(comm_rank)
+os.environ["WORLD_SIZE"] = str(comm_size)
+
+if args.use_cuda:
+    torch.cuda.set_device(local_rank)
+    device = torch.device("cuda", local_rank)
+else:
+    device = torch.device("cpu")
+
+dist.init_process_group("ucc", rank=comm_rank, world_size=comm_size)
+pg = dist.new_group(backend="ucc")
+
+
+# nccl-tests bus bandwidth factors, busbw = algbw * factor
+def bus_factor(op, n):
+    if op == "allreduce":
+        return 2.0 * (n - 1) / n
+    if op in ("broadcast", "reduce", "sendrecv"):
+        return 1.0
+    return (n - 1) / n
+
+
+ops = [op for op in args.ops.split(",") if op]
+for op in ops:
+    if op not in torch_ucc.bench_ops():
+        print("Unknown operation {}".format(op))
+        sys.exit(1)
+
+if comm_rank == 0:
+    print("# ProcessGroupUCC benchmark, world size {}, device {}, TLS {}".format(
+        comm_size, device.type, os.environ.get("TORCH_UCC_TLS", "default")))
+
+for op in ops:
+    if comm_rank == 0:
+        print("#\n# {}".format(op))
+        print("%12s %10s %10s %10s %10s %12s %12s" % (
+            "size(B)", "avg(us)", "p50(us)", "p99(us)", "max(us)",
+            "algbw(GB/s)", "busbw(GB/s)"))
+    sizes = [0] if op == "barrier" else []
+    size = args.min_size
+    while op != "barrier" and size <= args.max_size:
+        sizes.append(size)
+        size *= 2
+    for size in sizes:
+        times = torch_ucc.bench(pg, op, size, device, args.warmup, args.iters)
+        # every iteration is as slow as its slowest rank
+        times = torch.tensor(times, dtype=torch.float64)
+        dist.all_reduce(times, op=dist.ReduceOp.MAX, group=pg)
+        if comm_rank != 0:
+            continue
+        avg = times.mean().item()
+        p50 = torch.quantile(times, 0.5).item()
+        p99 = torch.quantile(times, 0.99).item()
+        algbw = size / avg / 1e3 if avg > 0 else 0.0
+        print("%12d %10.2f %10.2f %10.2f %10.2f %12.3f %12.3f" % (
+            size, avg, p50, p99, times.max().item(), algbw,
+            algbw * bus_factor(op, comm_size)))
@@ -0,0 +1,81 @@
+#
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+import sys
+import time
+from datetime import timedelta
+from torch_ucc_test_setup import *
+
+args = parse_test_args()
+pg = init_process_groups(args.backend, args.use_cuda)
+
+comm_size = dist.get_world_size()
+comm_rank = dist.get_rank()
+
+if comm_size < 2:
+    print("Test requires at least 2 ranks")
+    sys.exit(0)
+
+# completed works are waited regardless of timeout
+t = get_tensor(1024, args.use_cuda)
+dist.all_reduce(t, async_op=True).wait(timeout=timedelta(seconds=60))
+
+# receive is posted before matching send, wait has to time out
+t = torch.zeros(16, dtype=torch.int)
+estr = ""
+if comm_rank == 0:
+    req = dist.irecv(t, src=1, tag=0)
+    try:
+        req.wait(timeout=timedelta(milliseconds=100))
+    except Exception as e:
+        estr = str(e)
+dist.barrier(group=pg)
+if comm_rank == 1:
+    dist.send(torch.ones(16, dtype=torch.int), dst=0, tag=0)
+if comm_rank == 0:
+    # work is still valid after timeout
+    req.wait()
+    if "timed out" not in estr or not torch.all(t == 1):
+        print("Test Failed")
+        sys.exit(1)
+    print("Test work wait timeout: succeeded")
+
+# wait without timeout on a work still in flight blocks until it completes
+t = torch.zeros(16, dtype=torch.int)
+dist.barrier(group=pg)
+if comm_rank == 0:
+    req = dist.irecv(t, src=1, tag=1)
+    dist.barrier(group=pg)
+    req.wait()
+    if not torch.all(t == 1):
+        print("Test Failed")
+        sys.exit(1)
+else:
+    dist.barrier(group=pg)
+    if comm_rank == 1:
+        time.sleep(1)
+        dist.send(torch.ones(16, dtype=torch.int), dst=0, tag=1)
+
+# wait without timeout uses timeout of the process group
+short_pg = dist.new_group(backend="ucc", timeout=timedelta(seconds=1))
+t = torch.zeros(16, dtype=torch.int)
+estr = ""
+if comm_rank == 0:
+    req = dist.irecv(t, src=1, tag=2, group=short_pg)
+    try:
+        req.wait()
+    except Exception as e:
+        estr = str(e)
+dist.barrier(group=pg)
+if comm_rank == 1:
+    dist.send(torch.ones(16, dtype=torch.int), dst=0, tag=2, group=short_pg)
+if comm_rank == 0:
+    req.wait(timeout=timedelta(seconds=60))
+    if "timed out" not in estr:
+        print("Test Failed")
+        sys.exit(1)
+    print("Test work wait default timeout: succeeded")
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+#
+
+# Converts binary comms traces written with TORCH_UCC_ENABLE_COMMS_LOGGER=1
+# to JSON, see torch_ucc_tracing.hpp for the record layout.
+
+import argparse
+import glob
+import json
+import os
+import struct
+import sys
+
+MAGIC = b"UCCTRACE"
+VERSION = 1
+HEADER = struct.Struct("<8sIIii")
+COMM = struct.Struct("<qQqqii24s")
+SPLITS = struct.Struct("<8q")
+
+TRACE_COMM = 0
+TRACE_IN_SPLIT = 1
+TRACE_OUT_SPLIT = 2
+
+# c10::ScalarType
+DTYPES = [
+    "Byte",
+    "Char",
+    "Short",
+    "Int",
+    "Long",
+    "Half",
+    "Float",
+    "Double",
+    "ComplexHalf",
+    "ComplexFloat",
+    "ComplexDouble",
+    "Bool",
+    "QInt8",
+    "QUInt8",
+    "QInt32",
+    "BFloat16",
+]
+
+# c10::DeviceType
+DEVICE_TYPES = {0: "CPU", 1: "CUDA", 6: "HIP"}
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        raise ValueError("{}: truncated header".format(path))
+    magic, version, record_size, rank, world_size = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("{}: not a version {} UCC trace".format(path, VERSION))
+    comms = []
+    by_seq = {}
+    # last record may be partially written if the process was killed
+    end = HEADER.size + (len(data) - HEADER.size) // record_size * record_size
+    for off in range(HEADER.size, end, record_size):
+        rtype, dtype, dev_type, num_splits, root, seqnum = struct.unpack_from(
+            "<BbbBiQ", data, off
+        )
+        body = off + 16
+        if rtype == TRACE_COMM:
+            start_ns, req, in_size, out_size, ws, _, name = COMM.unpack_from(
+                data, body
+            )
+            comm = {
+                "markers": [],
+                "startTime_ns": start_ns,
+                "comms": name.split(b"\0", 1)[0].decode(),
+                "req": req,
+                "seqnum": seqnum,
+                "world_size": ws,
+            }
+            if dtype >= 0:
+                comm["in_msg_size"] = in_size
+                comm["out_msg_size"] = out_size
+                comm["dtype"] = (
+                    DTYPES[dtype] if dtype < len(DTYPES) else str(dtype)
+                )
+                comm["devType"] = DEVICE_TYPES.get(dev_type, str(dev_type))
+            if root != -1:
+                comm["root"] = root
+            comms.append(comm)
+            by_seq[seqnum] = comm
+        elif rtype in (TRACE_IN_SPLIT, TRACE_OUT_SPLIT):
+            comm = by_seq.get(seqnum)
+            if comm is None:
+                continue
+            splits = list(SPLITS.unpack_from(data, body)[:num_splits])
+            key = "in_split" if rtype == TRACE_IN_SPLIT else "out_split"
+            comm.setdefault("in_split", [])
+            comm.setdefault("out_split", [])
+            comm[key].extend(splits)
+    return rank, world_size, comms
+
+
+def main():
+    parser = argparse.ArgumentParser(description="UCC comms trace converter")
+    parser.add_argument(
+        "traces", nargs="+", help="trace files or directories with .bin traces"
+    )
+    parser.add_argument(
+        "--output-dir", type=str, default=None, help="default is next to input"
+    )
+    args = parser.parse_args()
+
+    files = []
+    for path in args.traces:
+        if os.path.isdir(path):
+            files += sorted(glob.glob(os.path.join(path, "*.bin")))
+        else:
+            files.append(path)
+    for path in files:
+        try:
+            rank, world_size, comms = read_trace(path)
+        except ValueError as e:
+            print(e, file=sys.stderr)
+            continue
+        out_dir = args.output_dir or os.path.dirname(path)
+        out = os.path.join(
+            out_dir, os.path.splitext(os.path.basename(path))[0] + ".json"
+        )
+        with open(out, "w") as f:
+            json.dump(comms, f, indent=1)
+        print("{}: rank {}/{}, {} records -> {}".format(
+            path, rank, world_size, len(comms), out))
+
+
+if __name__ == "__main__":
+    main()